@@ -44,6 +44,29 @@
 
 #define DHT_TYPE (DHT22) // DHT 22 (AM2302)
 
+// Status output. Binary frames are sent every iteration (10 Hz), the text
+// line once per second. Send 't' or 'b' over the serial line to switch
+// at runtime, e.g. 't' from the Arduino IDE serial monitor for debugging
+#define STATUS_MODE_TEXT (0)
+#define STATUS_MODE_BINARY (1)
+#define STATUS_MODE_DEFAULT (STATUS_MODE_BINARY)
+
+// Binary status frame (little-endian, 13 bytes), decoded by hydroctrl in
+// common/sensor/chassi_status_frame.hpp:
+//  [0]     sync 0xA5 (never part of the ASCII text mode output)
+//  [1]     frame type 0x01
+//  [2]     sequence number
+//  [3..4]  temp       int16, 1/100 degC
+//  [5..6]  temp2      int16, 1/100 degC
+//  [7..8]  humidity   uint16, 1/100 %RH
+//  [9..10] humidity2  uint16, 1/100 %RH
+//  [11]    flags: bit0 door alarm, bit1 chassi temp warning,
+//                 bit2 chassi temp alarm
+//  [12]    CRC-8 (poly 0x07, init 0x00) over bytes [1..11]
+#define STATUS_FRAME_SYNC (0xA5)
+#define STATUS_FRAME_TYPE (0x01)
+#define STATUS_FRAME_SIZE (13)
+
 //----------------------------------------------------------
 
 DHT_Unified dht_01(PIN_DHT_01, DHT_TYPE);
@@ -63,6 +86,9 @@ int g_temperature_controlled_fan_activation = TRUE;
 int g_iteration_ind_flag = 1;
 unsigned long g_iteration_counter = 0;
 
+int g_status_mode = STATUS_MODE_DEFAULT;
+uint8_t g_status_seq = 0;
+
 //----------------------------------------------------------
 
 void enable_relay(int pin)
@@ -81,6 +107,70 @@ void dht_init()
     dht_02.begin();
 }
 
+uint8_t crc8(const uint8_t* data, int len)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void put_u16(uint8_t* dst, uint16_t value)
+{
+    dst[0] = value & 0xff;
+    dst[1] = value >> 8;
+}
+
+void send_status_frame()
+{
+    uint8_t frame[STATUS_FRAME_SIZE];
+
+    frame[0] = STATUS_FRAME_SYNC;
+    frame[1] = STATUS_FRAME_TYPE;
+    frame[2] = g_status_seq++;
+    put_u16(&frame[3], (uint16_t)dht_01_temperature);
+    put_u16(&frame[5], (uint16_t)dht_02_temperature);
+    put_u16(&frame[7], (uint16_t)dht_01_humidity);
+    put_u16(&frame[9], (uint16_t)dht_02_humidity);
+    frame[11] = (g_door_alarm ? 0x01 : 0) |
+                (g_chassi_temp_warning ? 0x02 : 0) |
+                (g_chassi_temp_alarm ? 0x04 : 0);
+    frame[12] = crc8(&frame[1], STATUS_FRAME_SIZE - 2);
+
+    Serial.write(frame, STATUS_FRAME_SIZE);
+}
+
+void send_status_line()
+{
+    char status[1024];
+    snprintf(status, sizeof(status), "temp=%d.%d, temp2=%d.%d, humidity=%d.%d, humidity2=%d.%d, door_alarm=%d, chassi_temp_warning=%d, chassi_temp_alarm=%d;",
+      dht_01_temperature / 100, dht_01_temperature % 100,
+      dht_02_temperature / 100, dht_02_temperature % 100,
+      dht_01_humidity / 100, dht_01_humidity % 100,
+      dht_02_humidity / 100, dht_02_humidity % 100,
+      g_door_alarm,
+      g_chassi_temp_warning,
+      g_chassi_temp_alarm);
+
+    Serial.println(status);
+}
+
+void read_status_mode_request()
+{
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c == 't') {
+            g_status_mode = STATUS_MODE_TEXT;
+        } else if (c == 'b') {
+            g_status_mode = STATUS_MODE_BINARY;
+        }
+    }
+}
+
 void setup() {
   /********************************************************
    ******************** GPIO: PULLUP INPUT ****************
@@ -256,6 +346,12 @@ void loop() {
        ************** COMMUNICATE STATUS ***********************
       ********************************************************/
 
+      read_status_mode_request();
+
+      if (g_status_mode == STATUS_MODE_BINARY) {
+          send_status_frame();
+      }
+
       if (g_iteration_counter % 10 == 0) {
           g_iteration_ind_flag = !g_iteration_ind_flag;
           if (g_iteration_ind_flag) {
@@ -264,17 +360,9 @@ void loop() {
             digitalWrite(PIN_LED_ITERATION_IND, LOW);   
           }
 
-        char status[1024];
-        snprintf(status, sizeof(status), "temp=%d.%d, temp2=%d.%d, humidity=%d.%d, humidity2=%d.%d, door_alarm=%d, chassi_temp_warning=%d, chassi_temp_alarm=%d;",
-          dht_01_temperature / 100, dht_01_temperature % 100,
-          dht_02_temperature / 100, dht_02_temperature % 100,
-          dht_01_humidity / 100, dht_01_humidity % 100,
-          dht_02_humidity / 100, dht_02_humidity % 100,
-          g_door_alarm,
-          g_chassi_temp_warning,
-          g_chassi_temp_alarm);
-        
-        Serial.println(status);
+        if (g_status_mode == STATUS_MODE_TEXT) {
+            send_status_line();
+        }
       }
   }
 
@@ -17,7 +17,6 @@
  */
 
 #include <random>
-#include <sstream>
 
 #include <common/channel/channel.hpp>
 #include <common/log.hpp>
@@ -70,11 +69,10 @@ std::vector<int> channel::relay_indexes() { return relay_indexes_; }
 void channel::set_power_consumption_profile(
     common::power_consumption_profile profile)
 {
-    std::stringstream ss_msg;
-    ss_msg << "[" << common::channel_type_str(channel::channel::channel_type())
-           << "] power profile '"
-           << common::power_consumption_profile_str(profile) << "'";
-    common::log(common::log_level::log_level_info, ss_msg.str());
+    HC_LOG(common::log_level::log_level_info,
+           "[" << common::channel_type_str(channel::channel::channel_type())
+               << "] power profile '"
+               << common::power_consumption_profile_str(profile) << "'");
 
     power_profile_ = profile;
 }
@@ -90,10 +88,9 @@ common::power_consumption_profile channel::power_profile()
 
 std::chrono::milliseconds channel::random_start_delay()
 {
-    std::random_device rd;
     std::uniform_int_distribution<int> dist(
         0, static_cast<int>(hourly_reset_randomization_period.count() - 1));
-    auto value = dist(rd);
+    auto value = dist(ctx_->random_engine);
 
     return std::chrono::milliseconds(value);
 }
@@ -156,10 +153,9 @@ std::chrono::milliseconds channel::determine_activation_duration(
         duration = time_window;
     }
 
-    std::stringstream ss_msg;
-    ss_msg << "[channel::determine_activation_duration] duration "
-           << duration.count();
-    common::log(common::log_level::log_level_debug, ss_msg.str());
+    HC_LOG(common::log_level::log_level_debug,
+           "[channel::determine_activation_duration] duration "
+               << duration.count());
 
     return duration;
 }
@@ -17,7 +17,6 @@
  */
 
 #include <exception>
-#include <sstream>
 #include <thread>
 
 #include <common/channel/subsystem/main/ventilation_fan_channel.hpp>
@@ -53,8 +52,8 @@ common::ventilation_fan_mode ventilation_fan_channel::fan_mode()
 void ventilation_fan_channel::channel_activation_cb(
     common::task_context task_ctx, ventilation_fan_channel *_this)
 {
-    common::log(common::log_level::log_level_debug,
-                "[ventilation_fan_channel::channel_activation_cb]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[ventilation_fan_channel::channel_activation_cb]");
     _this->activate();
 }
 
@@ -64,14 +63,14 @@ void ventilation_fan_channel::channel_deactivation_cb(
     common::task_context task_ctx, ventilation_fan_channel *_this)
 {
     if (task_ctx.id != _this->latest_deactivation_task_id_) {
-        common::log(common::log_level::log_level_debug,
-                    "[ventilation_fan_channel::channel_deactivation_cb] ignore "
-                    "outdated timer callback");
+        HC_LOG(common::log_level::log_level_debug,
+               "[ventilation_fan_channel::channel_deactivation_cb] ignore "
+               "outdated timer callback");
         return;
     }
 
-    common::log(common::log_level::log_level_debug,
-                "[ventilation_fan_channel::channel_deactivation_cb]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[ventilation_fan_channel::channel_deactivation_cb]");
     _this->deactivate();
 }
 
@@ -79,8 +78,8 @@ void ventilation_fan_channel::channel_deactivation_cb(
 
 void ventilation_fan_channel::hourly_tick()
 {
-    common::log(common::log_level::log_level_debug,
-                "[ventilation_fan_channel::hourly_tick]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[ventilation_fan_channel::hourly_tick]");
 
     bool update_needed = channel_update_needed();
 
@@ -114,7 +113,7 @@ void ventilation_fan_channel::hourly_tick()
 
 bool ventilation_fan_channel::channel_update_needed()
 {
-    auto cabinet_status = ctx()->cabinet_status;
+    auto cabinet_status = ctx()->cabinet_status.load();
 
     // Manual mode
     if (fan_mode_ == common::ventilation_fan_mode::low ||
@@ -161,8 +160,8 @@ void ventilation_fan_channel::activate()
         return;
     }
 
-    common::log(common::log_level::log_level_debug,
-                "[ventilation_fan_channel::activate]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[ventilation_fan_channel::activate]");
 
     //*** activate relay ***
     auto indexes = relay_indexes();
@@ -174,33 +173,33 @@ void ventilation_fan_channel::activate()
     switch (fan_mode_) {
     case common::ventilation_fan_mode::low: {
         ctx()->relay_module->activate(indexes.at(0));
+        relay_active_ = true;
         fan_rpm_setting_ = common::ventilation_fan_mode::low;
-        std::stringstream ss_msg;
-        ss_msg << "[ventilation_fan_channel::activate] [manual] setting RPM to "
-                  "low";
-        common::log(common::log_level::log_level_debug, ss_msg.str());
+        HC_LOG(common::log_level::log_level_debug,
+               "[ventilation_fan_channel::activate] [manual] setting RPM to "
+               "low");
         break;
     }
     case common::ventilation_fan_mode::high: {
         ctx()->relay_module->activate(indexes.at(1));
+        relay_active_ = true;
         fan_rpm_setting_ = common::ventilation_fan_mode::high;
-        std::stringstream ss_msg;
-        ss_msg << "[ventilation_fan_channel::activate] [manual] setting RPM to "
-                  "high";
-        common::log(common::log_level::log_level_debug, ss_msg.str());
+        HC_LOG(common::log_level::log_level_debug,
+               "[ventilation_fan_channel::activate] [manual] setting RPM to "
+               "high");
         break;
     }
     case common::ventilation_fan_mode::automatic: {
-        auto cabinet_status = ctx()->cabinet_status;
+        auto cabinet_status = ctx()->cabinet_status.load();
 
         // Start on lowest setting
         if (fan_rpm_setting_ == common::ventilation_fan_mode::none) {
             ctx()->relay_module->activate(indexes.at(0));
+            relay_active_ = true;
             fan_rpm_setting_ = common::ventilation_fan_mode::low;
-            std::stringstream ss_msg;
-            ss_msg << "[ventilation_fan_channel::activate] [automatic] setting "
-                      "initial RPM to low";
-            common::log(common::log_level::log_level_debug, ss_msg.str());
+            HC_LOG(common::log_level::log_level_debug,
+                   "[ventilation_fan_channel::activate] [automatic] setting "
+                   "initial RPM to low");
             break;
         }
 
@@ -209,11 +208,11 @@ void ventilation_fan_channel::activate()
             cabinet_status.cabinet_temperature.value() >
                 ventilation_fan_high_rpm_upper_threshold) {
             ctx()->relay_module->activate(indexes.at(1));
+            relay_active_ = true;
             fan_rpm_setting_ = common::ventilation_fan_mode::high;
-            std::stringstream ss_msg;
-            ss_msg << "[ventilation_fan_channel::activate] [automatic] setting "
-                      "RPM to high";
-            common::log(common::log_level::log_level_debug, ss_msg.str());
+            HC_LOG(common::log_level::log_level_debug,
+                   "[ventilation_fan_channel::activate] [automatic] setting "
+                   "RPM to high");
             break;
         }
 
@@ -222,11 +221,11 @@ void ventilation_fan_channel::activate()
             cabinet_status.cabinet_temperature.value() <
                 ventilation_fan_high_rpm_lower_threshold) {
             ctx()->relay_module->activate(indexes.at(0));
+            relay_active_ = true;
             fan_rpm_setting_ = common::ventilation_fan_mode::low;
-            std::stringstream ss_msg;
-            ss_msg << "[ventilation_fan_channel::activate] [automatic] setting "
-                      "RPM to low";
-            common::log(common::log_level::log_level_debug, ss_msg.str());
+            HC_LOG(common::log_level::log_level_debug,
+                   "[ventilation_fan_channel::activate] [automatic] setting "
+                   "RPM to low");
             break;
         }
         break;
@@ -258,14 +257,15 @@ void ventilation_fan_channel::deactivate()
      * deactivation due to channel concurrency)
      */
 
-    common::log(common::log_level::log_level_debug,
-                "[ventilation_fan_channel::deactivate]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[ventilation_fan_channel::deactivate]");
 
     // deactivate relay channels: it is always safe to cut power
     auto indexes = relay_indexes();
     if (indexes.size() == 2) {
         ctx()->relay_module->deactivate(indexes.at(0));
         ctx()->relay_module->deactivate(indexes.at(1));
+        relay_active_ = false;
     } else {
         throw std::runtime_error(
             "[ventilation_fan_channel::deactivate] critical error");
@@ -274,5 +274,39 @@ void ventilation_fan_channel::deactivate()
 
 //---------------------------------------------------------------------------------------------------------------------
 
+void ventilation_fan_channel::cabinet_temperature_crossing(
+    common::temperature_crossing crossing)
+{
+    // Manual RPM selection is never overridden
+    if (fan_mode_ != common::ventilation_fan_mode::automatic) {
+        return;
+    }
+
+    auto target_rpm = crossing == common::temperature_crossing::rising
+                          ? common::ventilation_fan_mode::high
+                          : common::ventilation_fan_mode::low;
+    if (crossing == common::temperature_crossing::none ||
+        fan_rpm_setting_ == target_rpm || !relay_active_) {
+        return;
+    }
+
+    auto indexes = relay_indexes();
+
+    // The two relay channels are strictly mutually exclusive
+    deactivate();
+
+    ctx()->relay_module->activate(
+        indexes.at(target_rpm == common::ventilation_fan_mode::high ? 1 : 0));
+    relay_active_ = true;
+    fan_rpm_setting_ = target_rpm;
+
+    HC_LOG(common::log_level::log_level_debug,
+           "[ventilation_fan_channel::cabinet_temperature_crossing] "
+           "[automatic] setting RPM to "
+               << common::ventilation_fan_mode_str(target_rpm));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
 } // namespace hydroctrl
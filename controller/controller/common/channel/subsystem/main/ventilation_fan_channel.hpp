@@ -56,6 +56,16 @@ class ventilation_fan_channel : public channel
      */
     void deactivate() final;
 
+    /** @brief Cabinet temperature crossed an RPM threshold
+     *
+     * In automatic mode a running fan switches RPM right away. The
+     * deactivation timer is left as is. A fan that is not running picks the
+     * RPM at its next activation.
+     *
+     * @param crossing  Threshold crossing
+     */
+    void cabinet_temperature_crossing(common::temperature_crossing crossing);
+
   private:
     /** Channel update needed */
     bool channel_update_needed();
@@ -79,6 +89,9 @@ class ventilation_fan_channel : public channel
     common::ventilation_fan_mode fan_rpm_setting_{
         common::ventilation_fan_mode::none};
 
+    /** Fan relay powered */
+    bool relay_active_{false};
+
     /** All but the latest deactivation timers are ignored */
     hydroctrl::common::task_id latest_deactivation_task_id_{0};
 };
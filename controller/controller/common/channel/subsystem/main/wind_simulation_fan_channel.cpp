@@ -16,7 +16,6 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
-#include <sstream>
 
 #include <common/channel/subsystem/main/wind_simulation_fan_channel.hpp>
 #include <common/log.hpp>
@@ -38,8 +37,8 @@ wind_simulation_fan_channel::wind_simulation_fan_channel(
 void wind_simulation_fan_channel::channel_activation_cb(
     common::task_context task_ctx, wind_simulation_fan_channel *_this)
 {
-    common::log(common::log_level::log_level_debug,
-                "[wind_simulation_fan_channel::channel_activation_cb]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[wind_simulation_fan_channel::channel_activation_cb]");
     _this->activate();
 }
 
@@ -49,15 +48,14 @@ void wind_simulation_fan_channel::channel_deactivation_cb(
     common::task_context task_ctx, wind_simulation_fan_channel *_this)
 {
     if (task_ctx.id != _this->latest_deactivation_task_id_) {
-        common::log(common::log_level::log_level_debug,
-                    "[wind_simulation_fan_channel::channel_deactivation_cb] "
-                    "ignore outdated "
-                    "timer callback");
+        HC_LOG(common::log_level::log_level_debug,
+               "[wind_simulation_fan_channel::channel_deactivation_cb] "
+               "ignore outdated timer callback");
         return;
     }
 
-    common::log(common::log_level::log_level_debug,
-                "[wind_simulation_fan_channel::channel_deactivation_cb]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[wind_simulation_fan_channel::channel_deactivation_cb]");
     _this->deactivate();
 }
 
@@ -65,8 +63,8 @@ void wind_simulation_fan_channel::channel_deactivation_cb(
 
 void wind_simulation_fan_channel::hourly_tick()
 {
-    common::log(common::log_level::log_level_debug,
-                "[wind_simulation_fan_channel::hourly_tick]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[wind_simulation_fan_channel::hourly_tick]");
 
     auto hour = ctx()->clock->hour();
 
@@ -104,8 +102,8 @@ void wind_simulation_fan_channel::activate()
      * activation due to channel concurrency)
      */
 
-    common::log(common::log_level::log_level_debug,
-                "[wind_simulation_fan_channel::activate]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[wind_simulation_fan_channel::activate]");
 
     // activate relay
     auto indexes = relay_indexes();
@@ -138,8 +136,8 @@ void wind_simulation_fan_channel::deactivate()
      * deactivation due to channel concurrency)
      */
 
-    common::log(common::log_level::log_level_debug,
-                "[wind_simulation_fan_channel::deactivate]");
+    HC_LOG(common::log_level::log_level_debug,
+           "[wind_simulation_fan_channel::deactivate]");
 
     // deactivate relay
     auto indexes = relay_indexes();
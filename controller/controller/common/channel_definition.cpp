@@ -0,0 +1,149 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <common/channel_definition.hpp>
+#include <common/channel_index.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::size_t channel_relay_count(channel_type type)
+{
+    if (type == channel_type::ventilation_fan) {
+        return 2;
+    }
+
+    return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::vector<channel_definition> default_channel_definitions()
+{
+    // At the moment, rpm modes are disabled; ventilation fan has two
+    // identical entries
+    return {
+        {"ventilation_fan",
+         channel_type::ventilation_fan,
+         {relay_channel_idx_ventilation_fan_channel_high_rpm,
+          relay_channel_idx_ventilation_fan_channel_high_rpm}},
+        {"upper_full_spectrum_light",
+         channel_type::upper_full_spectrum_light,
+         {relay_channel_idx_upper_full_spectrum_light_channel}},
+        {"lower_full_spectrum_light",
+         channel_type::lower_full_spectrum_light,
+         {relay_channel_idx_lower_full_spectrum_light_channel}},
+        {"wind_simulation_fan",
+         channel_type::wind_simulation_fan,
+         {relay_channel_idx_wind_simulation_fan_channel}},
+        {"drip_irrigation",
+         channel_type::drip_irrigation,
+         {relay_channel_idx_drip_irrigation_channel}},
+    };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::vector<channel_definition>
+load_channel_definitions(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("cannot open channel definition file '" +
+                                 path + "'");
+    }
+
+    std::vector<channel_definition> definitions;
+    std::string line;
+    int line_nr = 0;
+
+    while (std::getline(file, line)) {
+        line_nr++;
+
+        std::istringstream ss(line);
+        std::string name;
+        std::string type;
+        std::string relays;
+        std::string trailing;
+
+        if (!(ss >> name) || name[0] == '#') {
+            continue;
+        }
+
+        auto error = [&](const std::string &msg) {
+            return std::runtime_error(path + ":" + std::to_string(line_nr) +
+                                      ": " + msg);
+        };
+
+        if (!(ss >> type >> relays) || (ss >> trailing)) {
+            throw error("expected '<name> <type> <relay>[,<relay>...]'");
+        }
+
+        channel_definition def;
+        def.name = name;
+        def.type = channel_type_from_id(type);
+        if (def.type == channel_type::unknown) {
+            throw error("unknown channel type '" + type + "'");
+        }
+
+        std::istringstream relay_ss(relays);
+        std::string relay;
+        while (std::getline(relay_ss, relay, ',')) {
+            std::size_t len = 0;
+            int idx = -1;
+            try {
+                idx = std::stoi(relay, &len);
+            } catch (const std::exception &) {
+                len = 0;
+            }
+            if (len == 0 || len != relay.size() || idx < 0) {
+                throw error("invalid relay index '" + relay + "'");
+            }
+            def.relay_indexes.emplace_back(idx);
+        }
+
+        auto relay_count = channel_relay_count(def.type);
+        if (def.relay_indexes.size() != relay_count) {
+            throw error("channel type '" + type + "' needs " +
+                        std::to_string(relay_count) + " relay(s), got " +
+                        std::to_string(def.relay_indexes.size()));
+        }
+
+        for (auto &&other : definitions) {
+            if (other.name == def.name) {
+                throw error("duplicate channel '" + def.name + "'");
+            }
+        }
+
+        definitions.emplace_back(def);
+    }
+
+    return definitions;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,89 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <common/channel_type.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** Channel definition, one per configured channel */
+struct channel_definition
+{
+    /** Unique channel name */
+    std::string name;
+
+    /** Channel type */
+    common::channel_type type{channel_type::unknown};
+
+    /** Relay module indexes */
+    std::vector<int> relay_indexes;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Number of relays a channel of the given type drives
+ *
+ * @param type  Channel type
+ *
+ * @return 2 for the ventilation fan (one relay per rpm mode), otherwise 1
+ */
+std::size_t channel_relay_count(channel_type type);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** Built-in channel layout of the chassi (relay idx 0-4) */
+std::vector<channel_definition> default_channel_definitions();
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Load channel definitions from file
+ *
+ * One channel per line: "<name> <type> <relay>[,<relay>...]", where type is
+ * a channel_type_id(). Empty lines and lines starting with '#' are ignored.
+ * Names must be unique and the number of relays must match
+ * channel_relay_count(). Relay indexes are range checked when the channels
+ * are created.
+ *
+ * Example:
+ *\code
+ * # name      type                       relays
+ * vent        ventilation_fan            0,0
+ * light_a     upper_full_spectrum_light  2
+ * light_b     upper_full_spectrum_light  5
+ *\endcode
+ *
+ * @param path  File path
+ *
+ * @return Channel definitions. Throws std::runtime_error on invalid input.
+ */
+std::vector<channel_definition>
+load_channel_definitions(const std::string &path);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,152 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <stdexcept>
+
+#include <common/channel/subsystem/main/drip_irrigation_channel.hpp>
+#include <common/channel/subsystem/main/full_spectrum_light_channel.hpp>
+#include <common/channel/subsystem/main/ventilation_fan_channel.hpp>
+#include <common/channel/subsystem/main/wind_simulation_fan_channel.hpp>
+#include <common/channel_registry.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+channel_registry::channel_registry(std::shared_ptr<common::controller_ctx> ctx)
+    : ctx_(ctx)
+{}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+size_t channel_registry::add(const channel_definition &def)
+{
+    if (name_map_.find(def.name) != name_map_.end()) {
+        throw std::runtime_error("[channel_registry::add] duplicate channel '" +
+                                 def.name + "'");
+    }
+
+    if (def.relay_indexes.size() != channel_relay_count(def.type)) {
+        throw std::runtime_error(
+            "[channel_registry::add] " +
+            std::to_string(def.relay_indexes.size()) + " relay(s) for '" +
+            def.name + "', expected " +
+            std::to_string(channel_relay_count(def.type)));
+    }
+
+    for (auto idx : def.relay_indexes) {
+        if (idx < 0 || idx >= ctx_->relay_module->size()) {
+            throw std::runtime_error(
+                "[channel_registry::add] relay index " + std::to_string(idx) +
+                " out of range for '" + def.name + "'");
+        }
+    }
+
+    auto ch = create_channel(def.type);
+    if (def.relay_indexes.size() == 1) {
+        ch->set_relay_module_idx(def.relay_indexes.at(0));
+    } else {
+        ch->set_relay_module_idx(def.relay_indexes);
+    }
+
+    size_t idx = channels_.size();
+    channels_.emplace_back(ch);
+    names_.emplace_back(def.name);
+    name_map_[def.name] = idx;
+    type_map_[def.type].emplace_back(idx);
+
+    return idx;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+size_t channel_registry::size() { return channels_.size(); }
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<channel> channel_registry::at(size_t idx)
+{
+    return channels_.at(idx);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+const std::string &channel_registry::name(size_t idx) { return names_.at(idx); }
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<channel> channel_registry::find(const std::string &name)
+{
+    auto it = name_map_.find(name);
+    if (it == name_map_.end()) {
+        return nullptr;
+    }
+
+    return channels_[it->second];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+const std::vector<size_t> &
+channel_registry::indexes_of(common::channel_type type)
+{
+    static const std::vector<size_t> none;
+
+    auto it = type_map_.find(type);
+    if (it == type_map_.end()) {
+        return none;
+    }
+
+    return it->second;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+const std::vector<std::shared_ptr<channel>> &channel_registry::channels()
+{
+    return channels_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<channel>
+channel_registry::create_channel(common::channel_type type)
+{
+    switch (type) {
+    case channel_type::ventilation_fan:
+        return std::make_shared<ventilation_fan_channel>(ctx_);
+    case channel_type::upper_full_spectrum_light:
+    case channel_type::lower_full_spectrum_light:
+        return std::make_shared<full_spectrum_light_channel>(type, ctx_);
+    case channel_type::wind_simulation_fan:
+        return std::make_shared<wind_simulation_fan_channel>(type, ctx_);
+    case channel_type::drip_irrigation:
+        return std::make_shared<drip_irrigation_channel>(type, ctx_);
+    case channel_type::unknown:
+    default:
+        throw std::runtime_error(
+            "[channel_registry::create_channel] unknown channel type");
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,127 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <common/channel/channel.hpp>
+#include <common/channel_definition.hpp>
+#include <common/controller_ctx.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Channel registry
+ *
+ * Channels are created from channel definitions and stored in an indexed
+ * vector. Lookup by name or channel type is a map access, so the number of
+ * channels is only limited by the relay module.
+ */
+class channel_registry
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param ctx  Controller context
+     */
+    explicit channel_registry(std::shared_ptr<common::controller_ctx> ctx);
+
+    /** @brief Create channel and add it to the registry
+     *
+     * Throws std::runtime_error for duplicate names, unknown channel types
+     * and relay indexes outside the relay module.
+     *
+     * @param def  Channel definition
+     *
+     * @return Channel index
+     */
+    size_t add(const channel_definition &def);
+
+    /** Number of channels */
+    size_t size();
+
+    /** @brief Channel at index
+     *
+     * @param idx  Channel index
+     */
+    std::shared_ptr<channel> at(size_t idx);
+
+    /** @brief Channel name at index
+     *
+     * @param idx  Channel index
+     */
+    const std::string &name(size_t idx);
+
+    /** @brief Find channel by name
+     *
+     * @param name  Channel name
+     *
+     * @return Channel, nullptr when not found
+     */
+    std::shared_ptr<channel> find(const std::string &name);
+
+    /** @brief Channel indexes of given type
+     *
+     * @param type  Channel type
+     *
+     * @return Channel indexes in registration order, empty when none
+     */
+    const std::vector<size_t> &indexes_of(common::channel_type type);
+
+    /** All channels in registration order */
+    const std::vector<std::shared_ptr<channel>> &channels();
+
+  private:
+    /** Create channel object for the given type */
+    std::shared_ptr<channel> create_channel(common::channel_type type);
+
+    /** Controller context */
+    std::shared_ptr<common::controller_ctx> ctx_;
+
+    /** Channels */
+    std::vector<std::shared_ptr<channel>> channels_;
+
+    /** Channel names, same index as channels_ */
+    std::vector<std::string> names_;
+
+    /** @brief Name map
+     *
+     * Key: Channel name
+     * Value: Channel index
+     */
+    std::unordered_map<std::string, size_t> name_map_;
+
+    /** @brief Type map
+     *
+     * Key: Channel type
+     * Value: Channel indexes
+     */
+    std::unordered_map<common::channel_type, std::vector<size_t>> type_map_;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
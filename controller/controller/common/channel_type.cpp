@@ -16,6 +16,9 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <array>
+#include <utility>
+
 #include <common/channel_type.hpp>
 
 namespace hydroctrl {
@@ -23,6 +26,18 @@ namespace common {
 
 //---------------------------------------------------------------------------------------------------------------------
 
+/** Channel type identifiers */
+static const std::array<std::pair<channel_type, const char *>, 5>
+    channel_type_ids = {{
+        {channel_type::upper_full_spectrum_light, "upper_full_spectrum_light"},
+        {channel_type::lower_full_spectrum_light, "lower_full_spectrum_light"},
+        {channel_type::drip_irrigation, "drip_irrigation"},
+        {channel_type::ventilation_fan, "ventilation_fan"},
+        {channel_type::wind_simulation_fan, "wind_simulation_fan"},
+    }};
+
+//---------------------------------------------------------------------------------------------------------------------
+
 /** Channel type as string */
 std::string channel_type_str(channel_type type)
 {
@@ -45,5 +60,31 @@ std::string channel_type_str(channel_type type)
 
 //---------------------------------------------------------------------------------------------------------------------
 
+std::string channel_type_id(channel_type type)
+{
+    for (auto &&entry : channel_type_ids) {
+        if (entry.first == type) {
+            return entry.second;
+        }
+    }
+
+    return "unknown";
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+channel_type channel_type_from_id(const std::string &id)
+{
+    for (auto &&entry : channel_type_ids) {
+        if (id == entry.second) {
+            return entry.first;
+        }
+    }
+
+    return channel_type::unknown;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
 } // namespace hydroctrl
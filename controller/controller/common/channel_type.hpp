@@ -53,5 +53,20 @@ std::string channel_type_str(channel_type type);
 
 //---------------------------------------------------------------------------------------------------------------------
 
+/** Channel type identifier, as used in channel definition files */
+std::string channel_type_id(channel_type type);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Channel type from identifier
+ *
+ * @param id  Identifier, see channel_type_id()
+ *
+ * @return Channel type, channel_type::unknown when not recognized
+ */
+channel_type channel_type_from_id(const std::string &id);
+
+//---------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
 } // namespace hydroctrl
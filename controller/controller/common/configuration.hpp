@@ -18,6 +18,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <common/channel_definition.hpp>
 #include <common/log.hpp>
 
 namespace hydroctrl {
@@ -33,8 +38,32 @@ struct configuration
     /** Help screen */
     bool help_screen{false};
 
+    /** Run log benchmark and exit */
+    bool log_benchmark{false};
+
     /** Request handling port */
     int request_handling_port{10};
+
+    /** Sensor ingest port (loopback UDP, fed by hydro_sensor_service) */
+    int sensor_ingest_port{204};
+
+    /** Chassi microcontroller serial device, empty when not connected */
+    std::string chassi_serial_device{"/dev/ttyACM0"};
+
+    /** Channel definitions */
+    std::vector<channel_definition> channels{default_channel_definitions()};
+
+    /** Simulated number of days in virtual time, 0 for normal operation */
+    int simulation_days{0};
+
+    /** Simulation start date (YYYY-MM-DD), empty for today */
+    std::string simulation_start;
+
+    /** Random seed in simulation mode */
+    uint32_t simulation_seed{1};
+
+    /** Additional simulated channels for measuring scheduler throughput */
+    int simulation_channels{0};
 };
 
 //-------------------------------------------------------------------------------------------------------------------
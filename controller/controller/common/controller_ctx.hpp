@@ -21,11 +21,13 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <random>
 
 #include <common/channel_type.hpp>
 #include <common/configuration.hpp>
 #include <common/power_consumption.hpp>
 #include <common/relay_module/relay_module.hpp>
+#include <common/seqlock.hpp>
 #include <common/system_clock.hpp>
 #include <common/task_scheduler/task_scheduler_interface.hpp>
 #include <common/unit/temperature.hpp>
@@ -68,6 +70,9 @@ struct cabinet_measurements
 {
     /** Cabinet temperature */
     temperature cabinet_temperature;
+
+    /** Cabinet humidity */
+    double cabinet_humidity{0};
 };
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -90,13 +95,16 @@ struct controller_ctx
     /** Relay module */
     std::shared_ptr<common::relay_module> relay_module{nullptr};
 
-    /** Chassi status */
-    chassi_measurements chassi_status;
+    /** Random engine (seeded from configuration in simulation mode) */
+    std::mt19937 random_engine;
+
+    /** Chassi status (lock-free, not protected by mutex) */
+    seqlock<chassi_measurements> chassi_status;
 
-    /** Cabinet status */
-    cabinet_measurements cabinet_status;
+    /** Cabinet status (lock-free, not protected by mutex) */
+    seqlock<cabinet_measurements> cabinet_status;
 
-    /** System wide alarm */
+    /** System wide alarm (door open or chassi overheating) */
     bool system_wide_alarm_{false};
 
     /** @brief Callback function: user_request_set_ventilation_fan_mode()
@@ -121,6 +129,15 @@ struct controller_ctx
      */
     std::shared_ptr<std::function<void(std::string)>>
         user_request_development_cmd{nullptr};
+
+    /** @brief Callback function: cabinet_temperature_crossing()
+     *
+     * Invoked by the sensor path with the mutex held
+     *
+     * @param crossing  Ventilation fan RPM threshold crossing
+     */
+    std::shared_ptr<std::function<void(common::temperature_crossing)>>
+        cabinet_temperature_crossing{nullptr};
 };
 
 //---------------------------------------------------------------------------------------------------------------------
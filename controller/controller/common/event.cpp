@@ -52,5 +52,16 @@ uint64_t timer_event::get_id() { return id_; }
 
 //---------------------------------------------------------------------------------------------------------------------------
 
+device_event::device_event(int fd)
+    : event::event(event_type::device), fd_(fd)
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------------
+
+int device_event::get_fd() { return fd_; }
+
+//---------------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
 } // namespace hydroctrl
\ No newline at end of file
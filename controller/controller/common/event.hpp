@@ -39,6 +39,9 @@ enum class event_type
 
     /** Socket event */
     socket = 1001,
+
+    /** Character device event, e.g. serial port */
+    device = 1002,
 };
 
 //---------------------------------------------------------------------------------------------------------------------------
@@ -112,5 +115,28 @@ class timer_event : public event
 
 //---------------------------------------------------------------------------------------------------------------------------
 
+/** Device event */
+class device_event : public event
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param fd  Device file descriptor
+     */
+    explicit device_event(int fd);
+
+    /** @brief Get file descriptor
+     *
+     * @return File descriptor
+     */
+    int get_fd();
+
+  private:
+    /** File descriptor */
+    int fd_;
+};
+
+//---------------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
 } // namespace hydroctrl
\ No newline at end of file
@@ -36,6 +36,9 @@ constexpr double microsec_to_nanosec_multiplier = 1000;
 /** Microsecond to sec divider */
 constexpr double microsec_to_sec_divider = 1000000;
 
+/** Second to nanosecond multiplier */
+constexpr int64_t sec_to_nanosec_multiplier = 1000000000;
+
 //---------------------------------------------------------------------------------------------------------------------------
 
 io_monitor::io_monitor() : timer_id_(0) { epoll_setup(); }
@@ -83,6 +86,46 @@ uint64_t io_monitor::register_one_shot_timer(std::chrono::microseconds duration)
 
 //---------------------------------------------------------------------------------------------------------------------------
 
+uint64_t io_monitor::register_wall_clock_timer(
+    std::chrono::system_clock::time_point expiry)
+{
+    int timer_fd;
+    struct itimerspec ts
+    {};
+    memset(&ts, 0, sizeof(ts));
+
+    timer_fd = system::timerfd_create(CLOCK_REALTIME, 0);
+    if (timer_fd < 0) {
+        throw std::system_error(
+            errno, std::system_category(),
+            "[io_monitor::register_wall_clock_timer] timerfd_create() failed");
+    }
+
+    auto nsecs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     expiry.time_since_epoch())
+                     .count();
+
+    ts.it_value.tv_sec = static_cast<time_t>(nsecs / sec_to_nanosec_multiplier);
+    ts.it_value.tv_nsec = static_cast<long>(nsecs % sec_to_nanosec_multiplier);
+
+    int res = system::timerfd_settime(
+        timer_fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &ts, nullptr);
+    if (res < 0) {
+        throw std::system_error(
+            errno, std::system_category(),
+            "[io_monitor::register_wall_clock_timer] timerfd_settime() failed");
+    }
+
+    epoll_add(timer_fd, event_type::timer);
+
+    timer_id_++;
+    timer_map_[timer_fd] = timer_id_;
+
+    return timer_id_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------
+
 void io_monitor::register_service_socket(const std::shared_ptr<socket> &socket)
 {
     int fd = socket->get_fd();
@@ -105,6 +148,24 @@ void io_monitor::register_client_socket(const std::shared_ptr<socket> &socket)
 
 //---------------------------------------------------------------------------------------------------------------------------
 
+void io_monitor::register_device(int fd) { epoll_add(fd, event_type::device); }
+
+//---------------------------------------------------------------------------------------------------------------------------
+
+void io_monitor::unregister_device(int fd)
+{
+    int res = system::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    if (res < 0) {
+        throw std::system_error(
+            errno, std::system_category(),
+            "[io_monitor::unregister_device] epoll_ctl() failed");
+    }
+
+    epoll_fd_cat_map_.erase(fd);
+}
+
+//---------------------------------------------------------------------------------------------------------------------------
+
 std::shared_ptr<timer_event> io_monitor::timerfd_handle_event(int fd)
 {
     constexpr int timerfd_rx_buffer_len = 4096;
@@ -113,7 +174,11 @@ std::shared_ptr<timer_event> io_monitor::timerfd_handle_event(int fd)
 
     ssize_t len = system::read(fd, buffer.data(), buffer.size());
 
-    if (len <= 0) {
+    // A wall clock timer is cancelled when the system clock is set. This is
+    // delivered as an expiry so that the owner can re-evaluate the time.
+    if (len < 0 && errno == ECANCELED) {
+        len = 0;
+    } else if (len <= 0) {
         throw std::system_error(
             errno, std::system_category(),
             "[io_monitor::timerfd_handle_event] read() failed");
@@ -211,13 +276,19 @@ std::vector<std::shared_ptr<event>> io_monitor::wait_for_events()
                         }
                         break;
                     }
+                    case event_type::device: {
+                        events.push_back(std::make_shared<device_event>(fd));
+                        break;
+                    }
                     }
                 }
             }
         } else if (res < 0) {
-            log(log_level_debug, "[io_monitor::wait_for_events] epoll error");
+            HC_LOG(log_level_debug,
+                   "[io_monitor::wait_for_events] epoll error");
         } else {
-            log(log_level_debug, "[io_monitor::wait_for_events] epoll timeout");
+            HC_LOG(log_level_debug,
+                   "[io_monitor::wait_for_events] epoll timeout");
         }
     }
 
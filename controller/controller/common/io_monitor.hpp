@@ -55,6 +55,18 @@ class io_monitor
      */
     uint64_t register_one_shot_timer(std::chrono::microseconds duration);
 
+    /** @brief Register one shot wall clock timer
+     *
+     * The timer expires when CLOCK_REALTIME reaches the given time point, or
+     * earlier if the system clock is set (e.g. 'date --set' or NTP step).
+     *
+     * @param expiry  Absolute wall clock time
+     *
+     * @return Timer identifier
+     */
+    uint64_t register_wall_clock_timer(
+        std::chrono::system_clock::time_point expiry);
+
     /** @brief Register service socket
      *
      * This registers a listening socket for monitoring.
@@ -71,6 +83,23 @@ class io_monitor
      */
     void register_client_socket(const std::shared_ptr<socket> &socket);
 
+    /** @brief Register device
+     *
+     * This registers a character device, e.g. a serial port, for monitoring.
+     * The caller owns the file descriptor and reads the data.
+     *
+     * @param fd  File descriptor
+     */
+    void register_device(int fd);
+
+    /** @brief Unregister device
+     *
+     * Must be called before the device file descriptor is closed.
+     *
+     * @param fd  File descriptor
+     */
+    void unregister_device(int fd);
+
     /** @brief Wait for events
      *
      * This waits for events to process. This method is intended to
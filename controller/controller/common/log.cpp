@@ -16,13 +16,21 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
-#include <iomanip>
-#include <iostream>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
-#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 #include <common/log.hpp>
 
@@ -31,7 +39,10 @@ namespace common {
 
 //-------------------------------------------------------------------------------------------------------------------
 
-static log_level g_log_level = log_level_default;
+std::atomic<log_level> g_log_level{log_level_default};
+
+/** Writer has been destroyed (static destruction at exit) */
+static std::atomic<bool> g_log_writer_stopped{false};
 
 //-------------------------------------------------------------------------------------------------------------------
 
@@ -44,49 +55,403 @@ static constexpr const std::array<const char *, log_level_str_array_size>
 
 //-------------------------------------------------------------------------------------------------------------------
 
-void set_log_level(log_level level) { g_log_level = level; }
+/** Message bytes stored per record; longer messages are truncated */
+constexpr std::size_t log_record_msg_size = 480;
+
+/** Records per thread ring buffer */
+constexpr uint32_t log_ring_size = 512;
+
+/** Writer wakeup interval when idle */
+constexpr std::chrono::milliseconds log_writer_interval(20);
+
+//-------------------------------------------------------------------------------------------------------------------
+
+/** @brief Log record
+ *
+ * Captured by the logging thread, formatted by the writer.
+ */
+struct log_record
+{
+    /** CLOCK_REALTIME */
+    struct timespec ts;
+
+    /** Log level */
+    log_level level;
+
+    /** Message length */
+    uint32_t len;
+
+    /** Message was truncated */
+    bool truncated;
+
+    /** Message, not terminated */
+    std::array<char, log_record_msg_size> msg;
+};
 
 //-------------------------------------------------------------------------------------------------------------------
 
-log_level get_log_level() { return g_log_level; }
+/** @brief Single producer, single consumer ring of log records
+ *
+ * The owning thread is the only producer; consumers are serialized by the
+ * writer mutex.
+ */
+struct log_ring
+{
+    /** Records */
+    std::array<log_record, log_ring_size> records{};
+
+    /** Next record to write, owned by producer */
+    alignas(64) std::atomic<uint32_t> head{0};
+
+    /** Next record to read, owned by consumer */
+    alignas(64) std::atomic<uint32_t> tail{0};
+
+    /** Records lost because the ring was full */
+    std::atomic<uint64_t> dropped{0};
+
+    /** Producer thread has exited */
+    std::atomic<bool> closed{false};
+};
+
+//-------------------------------------------------------------------------------------------------------------------
+
+/** @brief Background log writer
+ *
+ * Drains all thread rings, orders the records by time and writes them to
+ * stderr with one write() per batch.
+ */
+class log_writer
+{
+  public:
+    log_writer() : thread_(&log_writer::run, this) {}
+
+    ~log_writer()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wakeup_.notify_one();
+        thread_.join();
+        flush();
+        g_log_writer_stopped.store(true);
+    }
+
+    log_writer(const log_writer &other) = delete;
+    log_writer &operator=(const log_writer &other) = delete;
+
+    /** Create ring for calling thread */
+    std::shared_ptr<log_ring> register_ring()
+    {
+        auto ring = std::make_shared<log_ring>();
+        const std::lock_guard<std::mutex> lock(mutex_);
+        rings_.emplace_back(ring);
+        return ring;
+    }
+
+    /** Wake writer without waiting for the interval */
+    void notify() { wakeup_.notify_one(); }
+
+    /** Write everything logged so far */
+    void flush()
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        drain();
+    }
+
+  private:
+    /** Pending record */
+    struct pending_record
+    {
+        /** Record */
+        const log_record *record;
+
+        /** Index in rings_ */
+        std::size_t ring_idx;
+    };
+
+    /** Writer thread */
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            drain();
+            wakeup_.wait_for(lock, log_writer_interval);
+        }
+    }
+
+    /** Format and write pending records, mutex held */
+    void drain()
+    {
+        batch_.clear();
+        heads_.resize(rings_.size());
+
+        for (std::size_t idx = 0; idx < rings_.size(); idx++) {
+            auto &ring = *rings_[idx];
+            uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+            heads_[idx] = ring.head.load(std::memory_order_acquire);
+            for (uint32_t i = tail; i != heads_[idx]; i++) {
+                batch_.push_back({&ring.records[i % log_ring_size], idx});
+            }
+        }
+
+        // Records of different threads interleave by time
+        std::stable_sort(batch_.begin(), batch_.end(),
+                         [](const pending_record &a, const pending_record &b) {
+                             const auto &ta = a.record->ts;
+                             const auto &tb = b.record->ts;
+                             return ta.tv_sec != tb.tv_sec
+                                        ? ta.tv_sec < tb.tv_sec
+                                        : ta.tv_nsec < tb.tv_nsec;
+                         });
+
+        out_.clear();
+        for (auto &&entry : batch_) {
+            format(*entry.record);
+        }
+
+        for (auto &&ring : rings_) {
+            uint64_t dropped = ring->dropped.exchange(0);
+            if (dropped > 0) {
+                out_ += "[log] " + std::to_string(dropped) +
+                        " messages dropped, ring buffer full\n";
+            }
+        }
+
+        write_out();
+
+        // Records are released only after they have been formatted
+        for (std::size_t idx = 0; idx < rings_.size(); idx++) {
+            rings_[idx]->tail.store(heads_[idx], std::memory_order_release);
+        }
+
+        // Threads that have exited and whose records are written
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                    [](const std::shared_ptr<log_ring> &r) {
+                                        return r->closed.load() &&
+                                               r->tail.load() == r->head.load();
+                                    }),
+                     rings_.end());
+    }
+
+    /** Append formatted record to output buffer */
+    void format(const log_record &record)
+    {
+        // Date and time only change once per second
+        if (record.ts.tv_sec != cached_sec_) {
+            struct tm tm
+            {};
+            localtime_r(&record.ts.tv_sec, &tm);
+            strftime(cached_prefix_.data(), cached_prefix_.size(),
+                     "[%Y-%m-%d %H:%M:%S.", &tm);
+            cached_sec_ = record.ts.tv_sec;
+        }
+
+        constexpr long nsec_per_msec = 1000000;
+        std::array<char, 16> msec{};
+        snprintf(msec.data(), msec.size(), "%03ld] [",
+                 record.ts.tv_nsec / nsec_per_msec);
+
+        out_ += cached_prefix_.data();
+        out_ += msec.data();
+        out_ += g_log_level_str.at(static_cast<int>(record.level));
+        out_ += "] ";
+        out_.append(record.msg.data(), record.len);
+        if (record.truncated) {
+            out_ += "...";
+        }
+        out_ += '\n';
+    }
+
+    /** Write output buffer to stderr */
+    void write_out()
+    {
+        std::size_t offset = 0;
+        while (offset < out_.size()) {
+            ssize_t res = ::write(STDERR_FILENO, out_.data() + offset,
+                                  out_.size() - offset);
+            if (res <= 0) {
+                break;
+            }
+            offset += static_cast<std::size_t>(res);
+        }
+    }
+
+    /** Protects rings_ and serializes consumers */
+    std::mutex mutex_;
+
+    /** Wakeup */
+    std::condition_variable wakeup_;
+
+    /** Stop request */
+    bool stop_{false};
+
+    /** Ring per logging thread */
+    std::vector<std::shared_ptr<log_ring>> rings_;
+
+    /** Ring heads at the time the batch was collected */
+    std::vector<uint32_t> heads_;
+
+    /** Drain batch, reused */
+    std::vector<pending_record> batch_;
+
+    /** Output buffer, reused */
+    std::string out_;
+
+    /** Second of cached_prefix_ */
+    time_t cached_sec_{-1};
+
+    /** Formatted "[date time." of cached_sec_ */
+    std::array<char, 64> cached_prefix_{};
+
+    /** Writer thread, started last */
+    std::thread thread_;
+};
+
+//-------------------------------------------------------------------------------------------------------------------
+
+/** Writer, started on first use and stopped (after a final flush) at exit */
+static log_writer &writer()
+{
+    static log_writer instance;
+    return instance;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+
+/** Ring of the calling thread, handed back to the writer on thread exit */
+class thread_log_ring
+{
+  public:
+    thread_log_ring() : ring_(writer().register_ring()) {}
+
+    ~thread_log_ring() { ring_->closed.store(true); }
+
+    thread_log_ring(const thread_log_ring &other) = delete;
+    thread_log_ring &operator=(const thread_log_ring &other) = delete;
+
+    log_ring &get() { return *ring_; }
+
+  private:
+    std::shared_ptr<log_ring> ring_;
+};
+
+//-------------------------------------------------------------------------------------------------------------------
+
+void set_log_level(log_level level)
+{
+    g_log_level.store(level, std::memory_order_relaxed);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+
+log_level get_log_level()
+{
+    return g_log_level.load(std::memory_order_relaxed);
+}
 
 //-------------------------------------------------------------------------------------------------------------------
 
 void log(log_level level, const std::string &msg)
 {
-    if (level > g_log_level) {
+    if (level > g_log_level.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Late messages from static destructors
+    if (g_log_writer_stopped.load(std::memory_order_relaxed)) {
+        fprintf(stderr, "[%s] %s\n",
+                g_log_level_str.at(static_cast<int>(level)), msg.c_str());
         return;
     }
 
-    // Use gettimeofday() and strftime() to get custom timestamp string
-    struct timeval ts
-    {};
-    constexpr int str_size = 128;
-    std::array<char, str_size> timestamp_str{};
+    // Make sure the writer outlives the thread local ring
+    auto &log_writer = writer();
+    thread_local thread_log_ring thread_ring;
+    auto &ring = thread_ring.get();
+
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    uint32_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head - tail == log_ring_size) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        log_writer.notify();
+        return;
+    }
+
+    auto &record = ring.records[head % log_ring_size];
+    clock_gettime(CLOCK_REALTIME, &record.ts);
+    record.level = level;
+    record.truncated = msg.size() > record.msg.size();
+    record.len =
+        static_cast<uint32_t>(std::min(msg.size(), record.msg.size()));
+    memcpy(record.msg.data(), msg.data(), record.len);
+
+    ring.head.store(head + 1, std::memory_order_release);
+
+    // Severe conditions are written before returning, e.g. ahead of an abort
+    if (level <= log_level_crit) {
+        log_writer.flush();
+    } else if (level <= log_level_warning ||
+               head - tail >= log_ring_size / 2) {
+        log_writer.notify();
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+
+void log_flush() { writer().flush(); }
+
+//-------------------------------------------------------------------------------------------------------------------
+
+void log_benchmark()
+{
+    constexpr int iterations = 1000000;
+    constexpr int printed_iterations = 2000;
+    auto duration = std::chrono::microseconds(1500);
+
+    auto measure = [](int n, auto &&f) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            f(i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / n;
+    };
+
+    auto saved_level = get_log_level();
+    set_log_level(log_level_info);
+
+    // Message built before the level check, as call sites used to do
+    double eager_ns = measure(iterations, [&](int i) {
+        std::stringstream ss_msg;
+        ss_msg << "[log_benchmark] iteration " << i << " duration "
+               << duration.count();
+        log(log_level_debug, ss_msg.str());
+    });
 
-    gettimeofday(&ts, nullptr);
+    double lazy_ns = measure(iterations, [&](int i) {
+        HC_LOG(log_level_debug, "[log_benchmark] iteration "
+                                    << i << " duration " << duration.count());
+    });
 
-    std::stringstream ss_format;
+    set_log_level(log_level_debug);
 
-    ss_format << "[%Y-%m-%d %H:%M:%S." << std::setfill('0') << std::setw(3)
-              << static_cast<int>(static_cast<double>(ts.tv_usec) / 1000)
-              << "]";
+    double printed_ns = measure(printed_iterations, [&](int i) {
+        HC_LOG(log_level_debug, "[log_benchmark] iteration "
+                                    << i << " duration " << duration.count());
+    });
+    log_flush();
 
-// The whole idea with ss_format is that it is not a string literal and defined
-// in runtime
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wformat-nonliteral"
-    strftime(timestamp_str.data(), timestamp_str.size(),
-             ss_format.str().c_str(), localtime(&ts.tv_sec));
-#pragma GCC diagnostic pop
+    set_log_level(saved_level);
 
-    std::cerr << std::string(timestamp_str.data()) << " ["
-              << g_log_level_str.at(static_cast<int>(level)) << "] " << msg
-              << std::endl
-              << std::flush;
+    printf("Suppressed debug log, eager message: %8.1f ns\n", eager_ns);
+    printf("Suppressed debug log, HC_LOG():      %8.1f ns\n", lazy_ns);
+    printf("Printed debug log, HC_LOG():         %8.1f ns\n", printed_ns);
+    printf("Compiled in up to:                   %s\n",
+           g_log_level_str.at(HC_LOG_LEVEL_MAX));
 }
 
 //-------------------------------------------------------------------------------------------------------------------
 
 } // namespace common
-} // namespace hydroctrl
\ No newline at end of file
+} // namespace hydroctrl
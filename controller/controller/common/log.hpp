@@ -22,9 +22,20 @@
 
 #pragma once
 
+#include <atomic>
+#include <sstream>
 #include <string>
 #include <syslog.h>
 
+/** @brief Most verbose log level compiled in
+ *
+ * HC_LOG() statements above this level are removed at compile time, e.g.
+ * -DHC_LOG_LEVEL_MAX=LOG_INFO drops all debug logging from the binary.
+ */
+#ifndef HC_LOG_LEVEL_MAX
+#define HC_LOG_LEVEL_MAX LOG_DEBUG
+#endif
+
 namespace hydroctrl {
 namespace common {
 
@@ -56,6 +67,14 @@ constexpr log_level log_level_default = log_level_crit;
 
 //-------------------------------------------------------------------------------------------------------------------
 
+/** @brief Current log level
+ *
+ * Use set_log_level() and get_log_level(). Exposed for log_enabled().
+ */
+extern std::atomic<log_level> g_log_level;
+
+//-------------------------------------------------------------------------------------------------------------------
+
 /** @brief Set log level
  *
  * If this method isn't called log_level_default will be used.
@@ -74,11 +93,31 @@ log_level get_log_level();
 
 //-------------------------------------------------------------------------------------------------------------------
 
+/** @brief Check if a message would be printed
+ *
+ * @param level  Log level for message
+ *
+ * @return True when level passes both the compile time and runtime filter
+ */
+inline bool log_enabled(log_level level)
+{
+    return level <= HC_LOG_LEVEL_MAX &&
+           level <= g_log_level.load(std::memory_order_relaxed);
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+
 /** @brief Print log message
  *
  * Based on the current log level the method will determine if the print to
  * stderr should be performed or not.
  *
+ * The message is copied to a lock-free ring buffer of the calling thread and
+ * written by a background thread, so logging never blocks on stderr or on
+ * other logging threads. Messages at log_level_crit and above are written
+ * before the call returns. When a thread logs faster than the writer keeps up
+ * messages are dropped and the number of dropped messages is reported.
+ *
  * @param level  Log level for message
  * @param msg    Message
  */
@@ -86,5 +125,41 @@ void log(log_level level, const std::string &msg);
 
 //-------------------------------------------------------------------------------------------------------------------
 
+/** @brief Write all pending log messages
+ *
+ * Blocks until the messages logged so far have been written to stderr.
+ */
+void log_flush();
+
+//-------------------------------------------------------------------------------------------------------------------
+
+/** @brief Measure the cost of suppressed and printed log statements
+ *
+ * Results are printed to stdout; printed messages go to stderr.
+ */
+void log_benchmark();
+
+//-------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
-} // namespace hydroctrl
\ No newline at end of file
+} // namespace hydroctrl
+
+//-------------------------------------------------------------------------------------------------------------------
+
+/** @brief Log statement with lazy message construction
+ *
+ * The message is a stream expression and is only evaluated when the level is
+ * enabled; statements above HC_LOG_LEVEL_MAX compile to nothing.
+ *
+ * Example: HC_LOG(common::log_level_debug, "[x] duration " << d.count());
+ */
+#define HC_LOG(level, msg)                                                     \
+    do {                                                                       \
+        if constexpr ((level) <= HC_LOG_LEVEL_MAX) {                           \
+            if (::hydroctrl::common::log_enabled(level)) {                     \
+                std::ostringstream hc_log_ss;                                  \
+                hc_log_ss << msg;                                              \
+                ::hydroctrl::common::log(level, hc_log_ss.str());              \
+            }                                                                  \
+        }                                                                      \
+    } while (false)
@@ -21,6 +21,7 @@
 #include <iomanip>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 
 #include <common/log.hpp>
 #include <common/relay_module/relay_module.hpp>
@@ -51,6 +52,17 @@ relay_module::relay_module()
 
 //---------------------------------------------------------------------------------------------------------------------
 
+relay_module::relay_module(std::shared_ptr<virtual_clock> vclock, int size)
+    : size_(size), vclock_(std::move(vclock))
+{
+    activation_state_.resize(size_);
+    activation_histogram_.resize(size_);
+    activation_timepoint_refs_.resize(size_);
+    duration_histogram_.resize(size_);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 int relay_module::size() { return size_; }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -221,9 +233,18 @@ void relay_module::activate(int index)
         return;
     }
 
+    activation_state_[index] = true;
+    activation_histogram_[index]++;
+    activation_timepoint_refs_[index] = timestamp();
+
+    // Simulated relays only keep statistics
+    if (vclock_ != nullptr) {
+        return;
+    }
+
 #ifdef HC_RELAY_MODULE_ENABLED
 
-    common::log(common::log_level::log_level_debug, "[relay_module::activate]");
+    HC_LOG(common::log_level::log_level_debug, "[relay_module::activate]");
 
 #ifdef HC_RELAY_MODULE_16_CHANNELS
     auto ch = relay_module::index_to_channel_type(index);
@@ -237,14 +258,9 @@ void relay_module::activate(int index)
 #endif // HC_RELAY_MODULE_32_CHANNELS
 
 #else  // HC_RELAY_MODULE_ENABLED
-    std::stringstream msg;
-    msg << "[relay_module::activate] idx " << index << " (stubbed)";
-    common::log(common::log_level::log_level_notice, msg.str());
+    HC_LOG(common::log_level::log_level_notice,
+           "[relay_module::activate] idx " << index << " (stubbed)");
 #endif // HC_RELAY_MODULE_ENABLED
-
-    activation_state_[index] = true;
-    activation_histogram_[index]++;
-    activation_timepoint_refs_[index] = std::chrono::steady_clock::now();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -260,9 +276,20 @@ void relay_module::deactivate(int index)
         return;
     }
 
+    activation_state_[index] = false;
+
+    auto tp_now = timestamp();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        tp_now - activation_timepoint_refs_[index]);
+    duration_histogram_[index] += elapsed;
+
+    // Simulated relays only keep statistics
+    if (vclock_ != nullptr) {
+        return;
+    }
+
 #ifdef HC_RELAY_MODULE_ENABLED
-    common::log(common::log_level::log_level_debug,
-                "[relay_module::deactivate]");
+    HC_LOG(common::log_level::log_level_debug, "[relay_module::deactivate]");
 
 #ifdef HC_RELAY_MODULE_16_CHANNELS
     auto ch = relay_module::index_to_channel_type(index);
@@ -276,24 +303,22 @@ void relay_module::deactivate(int index)
 #endif // HC_RELAY_MODULE_32_CHANNELS
 
 #else  // HC_RELAY_MODULE_ENABLED
-    common::log(common::log_level::log_level_notice,
-                "[relay_module::deactivate] stubbed");
+    HC_LOG(common::log_level::log_level_notice,
+           "[relay_module::deactivate] stubbed");
 #endif // HC_RELAY_MODULE_ENABLED
-
-    activation_state_[index] = false;
-
-    auto tp_now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-        tp_now - activation_timepoint_refs_[index]);
-    duration_histogram_[index] += elapsed;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 
 void relay_module::clear()
 {
+    // Simulated relays have no hardware state
+    if (vclock_ != nullptr) {
+        return;
+    }
+
 #ifdef HC_RELAY_MODULE_ENABLED
-    common::log(common::log_level::log_level_debug, "[relay_module::clear]");
+    HC_LOG(common::log_level::log_level_debug, "[relay_module::clear]");
 
 #ifdef HC_RELAY_MODULE_16_CHANNELS
     rc_relay_channel_set(rc_relay_channel_01, false);
@@ -351,13 +376,27 @@ void relay_module::clear()
 #endif // HC_RELAY_MODULE_32_CHANNELS
 
 #else  // HC_RELAY_MODULE_ENABLED
-    common::log(common::log_level::log_level_notice,
-                "[relay_module::clear] stubbed");
+    HC_LOG(common::log_level::log_level_notice,
+           "[relay_module::clear] stubbed");
 #endif // HC_RELAY_MODULE_ENABLED
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 
+std::chrono::steady_clock::time_point relay_module::timestamp()
+{
+    if (vclock_ != nullptr) {
+        auto elapsed = vclock_->now().time_since_epoch();
+        return std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                elapsed));
+    }
+
+    return std::chrono::steady_clock::now();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 std::string relay_module::stats()
 {
     std::stringstream stats;
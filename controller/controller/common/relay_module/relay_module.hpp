@@ -20,6 +20,7 @@
 
 #include <chrono>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 #ifdef HC_RELAY_MODULE_16_CHANNELS
@@ -30,6 +31,8 @@
 #include <rc/relay_32.h>
 #endif // HC_RELAY_MODULE_32_CHANNELS
 
+#include <common/virtual_clock.hpp>
+
 namespace hydroctrl {
 namespace common {
 
@@ -53,6 +56,16 @@ class relay_module
     /** Constructor */
     relay_module();
 
+    /** @brief Constructor for simulated relay module
+     *
+     * No hardware is accessed. Activation durations are measured in virtual
+     * time.
+     *
+     * @param vclock  Virtual time source
+     * @param size    Number of relays
+     */
+    relay_module(std::shared_ptr<virtual_clock> vclock, int size);
+
     /** Number of relays */
     int size();
 
@@ -75,6 +88,9 @@ class relay_module
 
     rc_relay_channel_t index_to_channel_type(int index);
 
+    /** Timestamp for duration statistics */
+    std::chrono::steady_clock::time_point timestamp();
+
     /**
      *  @brief Relay activation state
      *
@@ -96,6 +112,9 @@ class relay_module
 
     /** Duration histogram */
     std::vector<std::chrono::milliseconds> duration_histogram_;
+
+    /** Virtual time source, nullptr for hardware relays */
+    std::shared_ptr<virtual_clock> vclock_;
 };
 
 //---------------------------------------------------------------------------------------------------------------------
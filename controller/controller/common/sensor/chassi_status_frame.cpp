@@ -0,0 +1,93 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <array>
+
+#include <common/sensor/chassi_status_frame.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** CRC-8 lookup table, polynomial 0x07 */
+static constexpr std::array<uint8_t, 256> crc8_table = [] {
+    std::array<uint8_t, 256> table{};
+    for (int i = 0; i < 256; i++) {
+        auto crc = static_cast<uint8_t>(i);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) != 0 ? static_cast<uint8_t>((crc << 1) ^ 0x07)
+                                    : static_cast<uint8_t>(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+//---------------------------------------------------------------------------------------------------------------------
+
+uint8_t crc8(const uint8_t *data, std::size_t len)
+{
+    uint8_t crc = 0;
+    for (std::size_t i = 0; i < len; i++) {
+        crc = crc8_table[crc ^ data[i]];
+    }
+    return crc;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static uint16_t get_u16(const uint8_t *src)
+{
+    return static_cast<uint16_t>(src[0] | (src[1] << 8));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+bool decode_chassi_status_frame(const uint8_t *frame,
+                                chassi_measurements &status)
+{
+    constexpr double centi = 100.0;
+
+    if (frame[0] != chassi_status_frame_sync ||
+        frame[1] != chassi_status_frame_type) {
+        return false;
+    }
+
+    if (crc8(&frame[1], chassi_status_frame_size - 2) !=
+        frame[chassi_status_frame_size - 1]) {
+        return false;
+    }
+
+    status.ambient_temp = static_cast<int16_t>(get_u16(&frame[3])) / centi;
+    status.chassi_temp = static_cast<int16_t>(get_u16(&frame[5])) / centi;
+    status.ambient_humidity = get_u16(&frame[7]) / centi;
+    status.chassi_humidity = get_u16(&frame[9]) / centi;
+
+    uint8_t flags = frame[11];
+    status.door_alarm = (flags & chassi_status_flag_door_alarm) != 0;
+    status.chassi_temp_warning = (flags & chassi_status_flag_temp_warning) != 0;
+    status.chassi_temp_alarm = (flags & chassi_status_flag_temp_alarm) != 0;
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,93 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+/** @file chassi_status_frame.hpp
+ * @brief Binary status frame of the chassi microcontroller
+ *
+ * Layout (little-endian), see arduino_controller/chassi_microcontroller.ino:
+ *
+ * | Offset | Size | Field                                               |
+ * |--------|------|-----------------------------------------------------|
+ * | 0      | 1    | Sync 0xA5 (never part of the ASCII text mode)       |
+ * | 1      | 1    | Frame type 0x01                                     |
+ * | 2      | 1    | Sequence number                                     |
+ * | 3      | 2    | Ambient temperature, int16, 1/100 degC              |
+ * | 5      | 2    | Chassi temperature, int16, 1/100 degC               |
+ * | 7      | 2    | Ambient humidity, uint16, 1/100 %RH                 |
+ * | 9      | 2    | Chassi humidity, uint16, 1/100 %RH                  |
+ * | 11     | 1    | Flags: door alarm, chassi temp warning, temp alarm  |
+ * | 12     | 1    | CRC-8 (poly 0x07, init 0x00) over offsets 1-11      |
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include <common/controller_ctx.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** Frame start marker */
+constexpr uint8_t chassi_status_frame_sync = 0xA5;
+
+/** Frame type: status */
+constexpr uint8_t chassi_status_frame_type = 0x01;
+
+/** Frame size including sync and CRC */
+constexpr std::size_t chassi_status_frame_size = 13;
+
+/** Flag: door open */
+constexpr uint8_t chassi_status_flag_door_alarm = 0x01;
+
+/** Flag: chassi temperature warning */
+constexpr uint8_t chassi_status_flag_temp_warning = 0x02;
+
+/** Flag: chassi temperature alarm */
+constexpr uint8_t chassi_status_flag_temp_alarm = 0x04;
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief CRC-8, polynomial 0x07, initial value 0x00
+ *
+ * @param data  Data
+ * @param len   Data length
+ *
+ * @return CRC
+ */
+uint8_t crc8(const uint8_t *data, std::size_t len);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Decode binary status frame
+ *
+ * @param frame   chassi_status_frame_size bytes, starting with the sync byte
+ * @param status  Updated on success
+ *
+ * @return True when type and CRC are valid
+ */
+bool decode_chassi_status_frame(const uint8_t *frame,
+                                chassi_measurements &status);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,271 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <common/log.hpp>
+#include <common/sensor/chassi_status_reader.hpp>
+#include <common/string_processing/scan.hpp>
+#include <common/system/system.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+bool parse_chassi_status_line(std::string_view line,
+                              chassi_measurements &status)
+{
+    double temp = 0;
+    double temp2 = 0;
+    double humidity = 0;
+    double humidity2 = 0;
+    int door_alarm = 0;
+    int chassi_temp_warning = 0;
+    int chassi_temp_alarm = 0;
+
+    // Every frame starts with the ambient temperature
+    if (!scan_double(line, "temp=", temp)) {
+        return false;
+    }
+    status.ambient_temp = temp;
+
+    if (scan_double(line, "temp2=", temp2)) {
+        status.chassi_temp = temp2;
+    }
+    if (scan_double(line, "humidity=", humidity)) {
+        status.ambient_humidity = humidity;
+    }
+    if (scan_double(line, "humidity2=", humidity2)) {
+        status.chassi_humidity = humidity2;
+    }
+    if (scan_integer(line, "door_alarm=", door_alarm)) {
+        status.door_alarm = door_alarm != 0;
+    }
+    if (scan_integer(line, "chassi_temp_warning=", chassi_temp_warning)) {
+        status.chassi_temp_warning = chassi_temp_warning != 0;
+    }
+    if (scan_integer(line, "chassi_temp_alarm=", chassi_temp_alarm)) {
+        status.chassi_temp_alarm = chassi_temp_alarm != 0;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+chassi_status_reader::chassi_status_reader(std::string device)
+    : device_(std::move(device))
+{}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+chassi_status_reader::~chassi_status_reader() { close(); }
+
+//---------------------------------------------------------------------------------------------------------------------
+
+int chassi_status_reader::open()
+{
+    close();
+
+    int fd =
+        ::open(device_.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct termios tio
+    {};
+    if (tcgetattr(fd, &tio) < 0) {
+        int err = errno;
+        system::close(fd);
+        errno = err;
+        return -1;
+    }
+
+    // Raw 8N1 at 9600 baud; the microcontroller sends text but no line
+    // discipline processing is wanted
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B9600);
+    cfsetospeed(&tio, B9600);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    // With VMIN 0 an empty read returns 0 instead of EAGAIN, which would be
+    // indistinguishable from a hangup
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        int err = errno;
+        system::close(fd);
+        errno = err;
+        return -1;
+    }
+
+    // Opening the port resets the microcontroller; stale input is useless
+    tcflush(fd, TCIFLUSH);
+
+    fd_ = fd;
+    frame_len_ = 0;
+    frame_overflow_ = false;
+    binary_frame_len_ = 0;
+
+    HC_LOG(common::log_level_debug,
+           "[chassi_status_reader::open] " << device_ << " fd " << fd_);
+
+    return fd_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void chassi_status_reader::close()
+{
+    if (fd_ != -1) {
+        system::close(fd_);
+        fd_ = -1;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+int chassi_status_reader::get_fd() { return fd_; }
+
+//---------------------------------------------------------------------------------------------------------------------
+
+const std::string &chassi_status_reader::device() { return device_; }
+
+//---------------------------------------------------------------------------------------------------------------------
+
+int chassi_status_reader::read_input(chassi_measurements &status)
+{
+    int frames = 0;
+    std::array<char, 512> rx_buffer{};
+
+    if (fd_ == -1) {
+        return -1;
+    }
+
+    while (true) {
+        ssize_t len = system::read(fd_, rx_buffer.data(), rx_buffer.size());
+        if (len > 0) {
+            std::string_view data(rx_buffer.data(),
+                                  static_cast<std::size_t>(len));
+            frames += frame_input(data, status);
+            continue;
+        }
+
+        if (len < 0 && (errno == EAGAIN || errno == EINTR)) {
+            break;
+        }
+
+        // Hangup (USB cable pulled, pty master closed) or read error
+        HC_LOG(common::log_level_warning,
+               "[chassi_status_reader::read_input] " << device_
+                   << " disconnected");
+        return -1;
+    }
+
+    return frames;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+int chassi_status_reader::frame_input(std::string_view data,
+                                      chassi_measurements &status)
+{
+    int frames = 0;
+
+    for (char c : data) {
+        auto byte = static_cast<uint8_t>(c);
+
+        // Binary frame in progress: fixed length, no terminator
+        if (binary_frame_len_ > 0) {
+            binary_frame_[binary_frame_len_++] = byte;
+            if (binary_frame_len_ == chassi_status_frame_size) {
+                frames += complete_binary_frame(status);
+            }
+            continue;
+        }
+
+        if (byte == chassi_status_frame_sync) {
+            binary_frame_[0] = byte;
+            binary_frame_len_ = 1;
+            frame_len_ = 0;
+            frame_overflow_ = false;
+            continue;
+        }
+
+        if (c == ';' || c == '\n' || c == '\r') {
+            if (!frame_overflow_ && frame_len_ > 0 &&
+                parse_chassi_status_line(
+                    std::string_view(frame_.data(), frame_len_), status)) {
+                frames++;
+            }
+            frame_len_ = 0;
+            frame_overflow_ = false;
+            continue;
+        }
+
+        if (frame_len_ == frame_.size()) {
+            frame_overflow_ = true;
+            continue;
+        }
+
+        frame_[frame_len_++] = c;
+    }
+
+    return frames;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+int chassi_status_reader::complete_binary_frame(chassi_measurements &status)
+{
+    if (decode_chassi_status_frame(binary_frame_.data(), status)) {
+        binary_frame_len_ = 0;
+        return 1;
+    }
+
+    binary_frame_errors_++;
+    HC_LOG(common::log_level_debug,
+           "[chassi_status_reader::complete_binary_frame] invalid frame ("
+               << binary_frame_errors_ << " total)");
+
+    // The sync byte may have been payload; resume at the next candidate
+    binary_frame_len_ = 0;
+    for (std::size_t i = 1; i < chassi_status_frame_size; i++) {
+        if (binary_frame_[i] == chassi_status_frame_sync) {
+            binary_frame_len_ = chassi_status_frame_size - i;
+            std::copy(binary_frame_.begin() + static_cast<std::ptrdiff_t>(i),
+                      binary_frame_.end(), binary_frame_.begin());
+            break;
+        }
+    }
+
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,169 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+/** @file chassi_status_reader.hpp
+ * @brief Chassi microcontroller status over serial line
+ */
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <common/controller_ctx.hpp>
+#include <common/sensor/chassi_status_frame.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Parse one chassi microcontroller status line
+ *
+ * Format: "temp=24.50, temp2=31.20, humidity=40.10, humidity2=38.00,
+ * door_alarm=0, chassi_temp_warning=1, chassi_temp_alarm=0" (terminator
+ * already stripped). The first sensor measures the ambient air around the
+ * chassi, the second sensor the inside of the chassi.
+ *
+ * @param line    Status line
+ * @param status  Updated with the fields present in the line
+ *
+ * @return True when the line holds a status frame
+ */
+bool parse_chassi_status_line(std::string_view line,
+                              chassi_measurements &status);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Chassi status reader
+ *
+ * Non-blocking reader for the serial port of the chassi microcontroller
+ * (9600 baud, 8N1). Both output modes of the firmware are accepted: binary
+ * status frames (10 Hz, see chassi_status_frame.hpp) and text lines terminated
+ * by ';' or a line break (1 Hz, for debugging). The sync byte of a binary frame
+ * is outside the ASCII range, which tells the two apart. Partial frames are
+ * carried over to the next read. Any terminal device works, including a pseudo
+ * terminal for running without hardware.
+ */
+class chassi_status_reader
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param device  Device path, e.g. /dev/ttyACM0
+     */
+    explicit chassi_status_reader(std::string device);
+
+    /** @brief Destructor
+     *
+     * The device is closed
+     */
+    ~chassi_status_reader();
+
+    /** @brief Copy constructor
+     */
+    chassi_status_reader(const chassi_status_reader &other) = delete;
+
+    /** @brief Copy assignment operator
+     */
+    chassi_status_reader &
+    operator=(const chassi_status_reader &other) = delete;
+
+    /** @brief Open and configure device
+     *
+     * @return File descriptor, or -1 on failure (errno is set)
+     */
+    int open();
+
+    /** Close device */
+    void close();
+
+    /** @brief Get device handle
+     *
+     * @return File descriptor, -1 when closed
+     */
+    int get_fd();
+
+    /** @brief Get device path
+     *
+     * @return Device path
+     */
+    const std::string &device();
+
+    /** @brief Read available input
+     *
+     * Never blocks.
+     *
+     * @param status  Updated with each complete status frame
+     *
+     * @return Number of complete status frames, -1 on hangup or read error
+     *         (the caller stops monitoring and closes the device)
+     */
+    int read_input(chassi_measurements &status);
+
+  private:
+    /** @brief Frame input
+     *
+     * @param data    Received bytes
+     * @param status  Updated with each complete status frame
+     *
+     * @return Number of complete status frames
+     */
+    int frame_input(std::string_view data, chassi_measurements &status);
+
+    /** @brief Complete binary frame
+     *
+     * On a CRC error the frame is scanned for the next sync byte.
+     *
+     * @param status  Updated when the frame is valid
+     *
+     * @return Number of valid frames (0 or 1)
+     */
+    int complete_binary_frame(chassi_measurements &status);
+
+    /** Device path */
+    std::string device_;
+
+    /** File descriptor */
+    int fd_{-1};
+
+    /** Partial frame */
+    std::array<char, 256> frame_{};
+
+    /** Partial frame length */
+    std::size_t frame_len_{0};
+
+    /** Frame overflow, discard until next terminator */
+    bool frame_overflow_{false};
+
+    /** Partial binary frame */
+    std::array<uint8_t, chassi_status_frame_size> binary_frame_{};
+
+    /** Partial binary frame length, 0 when not inside a binary frame */
+    std::size_t binary_frame_len_{0};
+
+    /** Rejected binary frames */
+    uint64_t binary_frame_errors_{0};
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,252 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <array>
+#include <cstring>
+
+#include <common/log.hpp>
+#include <common/sensor/sensor_ingest.hpp>
+#include <common/string_processing/scan.hpp>
+#include <common/system/system.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** Retry interval while the chassi serial device is missing */
+constexpr std::chrono::seconds chassi_reopen_interval(5);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+sensor_ingest::sensor_ingest(std::shared_ptr<common::configuration> config,
+                             std::shared_ptr<common::controller_ctx> ctx)
+    : ctx_(ctx)
+{
+    io_monitor_ = std::make_shared<common::io_monitor>();
+    socket_ = create_socket(config->sensor_ingest_port);
+    io_monitor_->register_client_socket(socket_);
+
+    if (!config->chassi_serial_device.empty()) {
+        chassi_reader_ = std::make_unique<chassi_status_reader>(
+            config->chassi_serial_device);
+        open_chassi_serial();
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void sensor_ingest::open_chassi_serial()
+{
+    chassi_reopen_timer_id_ = 0;
+
+    int fd = chassi_reader_->open();
+    if (fd < 0) {
+        HC_LOG(common::log_level_warning,
+               "[sensor_ingest::open_chassi_serial] "
+                   << chassi_reader_->device() << ": " << strerror(errno));
+        chassi_reopen_timer_id_ =
+            io_monitor_->register_one_shot_timer(chassi_reopen_interval);
+        return;
+    }
+
+    io_monitor_->register_device(fd);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void sensor_ingest::handle_chassi_input()
+{
+    // Single writer of the chassi status
+    auto status = ctx_->chassi_status.load();
+
+    int frames = chassi_reader_->read_input(status);
+    if (frames > 0) {
+        ctx_->chassi_status.store(status);
+        update_system_wide_alarm(status);
+    }
+
+    if (frames < 0) {
+        io_monitor_->unregister_device(chassi_reader_->get_fd());
+        chassi_reader_->close();
+        chassi_reopen_timer_id_ =
+            io_monitor_->register_one_shot_timer(chassi_reopen_interval);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void sensor_ingest::update_system_wide_alarm(const chassi_measurements &status)
+{
+    // The temperature warning stays on the microcontroller's local indicators;
+    // an open door or a chassi temperature alarm is system wide
+    bool alarm = status.door_alarm || status.chassi_temp_alarm;
+    if (alarm == chassi_alarm_) {
+        return;
+    }
+    chassi_alarm_ = alarm;
+
+    if (alarm) {
+        HC_LOG(common::log_level_alert,
+               "[sensor_ingest::update_system_wide_alarm] alarm raised:"
+                   << (status.door_alarm ? " door open" : "")
+                   << (status.chassi_temp_alarm ? " chassi temperature" : ""));
+    } else {
+        HC_LOG(common::log_level_notice,
+               "[sensor_ingest::update_system_wide_alarm] alarm cleared");
+    }
+
+    const std::lock_guard<std::mutex> lock(*ctx_->mutex);
+    ctx_->system_wide_alarm_ = alarm;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<common::socket> sensor_ingest::create_socket(int port)
+{
+    auto sock = std::make_shared<common::socket>(AF_INET, SOCK_DGRAM, 0);
+
+    int res = common::system::fcntl(sock->get_fd(), F_SETFD, FD_CLOEXEC);
+    if (res == -1) {
+        throw std::system_error(errno, std::system_category(),
+                                "[sensor_ingest::create_socket] Failed to set "
+                                "FD_CLOEXEC");
+    }
+
+    // Relayed locally by hydro_sensor_service; not reachable from the network
+    struct sockaddr_in addr
+    {};
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    res = common::system::bind(sock->get_fd(), addr);
+    if (res == -1) {
+        throw std::system_error(errno, std::system_category(),
+                                "[sensor_ingest::create_socket] bind() failed");
+    }
+
+    HC_LOG(common::log_level_debug,
+           "[sensor_ingest::create_socket] fd " << sock->get_fd() << ", port "
+               << port);
+
+    return sock;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+bool sensor_ingest::ingest(std::string_view msg)
+{
+    double ambient_temp = 0;
+    double ambient_humidity = 0;
+
+    bool has_temp = scan_double(msg, "ambient_temperature ", ambient_temp);
+    bool has_humidity = scan_double(msg, "ambient_humidity ", ambient_humidity);
+
+    if (!has_temp && !has_humidity) {
+        return false;
+    }
+
+    // The ambient sensor of the sensor service is located inside the grow
+    // cabinet; chassi ambient readings come from the chassi microcontroller
+    ctx_->cabinet_status.update([&](cabinet_measurements &cabinet) {
+        if (has_temp) {
+            cabinet.cabinet_temperature =
+                temperature(temperature::temp_unit::celcius, ambient_temp);
+        }
+        if (has_humidity) {
+            cabinet.cabinet_humidity = ambient_humidity;
+        }
+    });
+
+    if (has_temp) {
+        // React at the sample rate rather than the next hourly tick
+        auto crossing = cabinet_temp_hysteresis_.update(ambient_temp);
+        if (crossing != temperature_crossing::none &&
+            ctx_->cabinet_temperature_crossing != nullptr) {
+            HC_LOG(common::log_level_debug,
+                   "[sensor_ingest::ingest] cabinet temperature "
+                       << ambient_temp
+                       << (crossing == temperature_crossing::rising
+                               ? " above upper threshold"
+                               : " below lower threshold"));
+
+            const std::lock_guard<std::mutex> lock(*ctx_->mutex);
+            (*ctx_->cabinet_temperature_crossing)(crossing);
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void sensor_ingest::run()
+{
+    HC_LOG(common::log_level_debug, "[sensor_ingest::run]");
+
+    std::array<char, 2048> rx_buffer{};
+    gsl::span<char> span_buff(rx_buffer.data(), rx_buffer.size());
+
+    while (true) {
+        auto events = io_monitor_->wait_for_events();
+
+        for (auto &&event : events) {
+            if (event->get_type() == common::event_type::device) {
+                handle_chassi_input();
+                continue;
+            }
+
+            if (event->get_type() == common::event_type::timer) {
+                auto timer_event =
+                    std::dynamic_pointer_cast<common::timer_event>(event);
+                if (chassi_reopen_timer_id_ != 0 &&
+                    timer_event->get_id() == chassi_reopen_timer_id_) {
+                    open_chassi_serial();
+                }
+                continue;
+            }
+
+            // Datagram boundaries frame the messages; drain the socket
+            while (true) {
+                struct sockaddr_in addr
+                {};
+                socklen_t addr_len = sizeof(addr);
+                ssize_t len =
+                    common::system::recvfrom(socket_->get_fd(), span_buff,
+                                             MSG_DONTWAIT, addr, &addr_len);
+                if (len <= 0) {
+                    break;
+                }
+
+                std::string_view msg(rx_buffer.data(),
+                                     static_cast<std::size_t>(len));
+                if (!ingest(msg)) {
+                    HC_LOG(common::log_level_debug,
+                           "[sensor_ingest::run] unrecognized message");
+                }
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
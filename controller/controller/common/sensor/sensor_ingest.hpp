@@ -0,0 +1,121 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+/** @file sensor_ingest.hpp
+ * @brief Live sensor readings into the controller context
+ */
+
+#include <memory>
+#include <string_view>
+
+#include <common/configuration.hpp>
+#include <common/controller_ctx.hpp>
+#include <common/io_monitor.hpp>
+#include <common/network/socket.hpp>
+#include <common/sensor/chassi_status_reader.hpp>
+#include <common/ventilation_fan.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Sensor ingest
+ *
+ * Receives the sensor datagrams relayed by hydro_sensor_service (e.g.
+ * "ambient_temperature 23.40, ambient_humidity 41.20") on a loopback UDP port
+ * and the status lines of the chassi microcontroller on its serial port, and
+ * publishes them through the controller context seqlocks. The controller
+ * mutex is only taken when the cabinet temperature crosses a ventilation fan
+ * RPM threshold or the chassi alarm changes, so ingestion does not contend
+ * with the task scheduler.
+ */
+class sensor_ingest
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param config  Configuration
+     * @param ctx     Controller context
+     */
+    sensor_ingest(std::shared_ptr<common::configuration> config,
+                  std::shared_ptr<common::controller_ctx> ctx);
+
+    /** @brief Sensor ingest execution loop
+     */
+    void run();
+
+    /** @brief Parse one sensor message and update the context
+     *
+     * @param msg  Sensor message
+     *
+     * @return True when at least one reading was recognized
+     */
+    bool ingest(std::string_view msg);
+
+  private:
+    /** Open chassi serial device, retried periodically while missing */
+    void open_chassi_serial();
+
+    /** Read chassi serial device */
+    void handle_chassi_input();
+
+    /** @brief Raise or clear system wide alarm
+     *
+     * @param status  Chassi status
+     */
+    void update_system_wide_alarm(const chassi_measurements &status);
+
+    /** @brief Create UDP socket bound to the loopback interface
+     *
+     * @param port  UDP port
+     *
+     * @return Socket
+     */
+    static std::shared_ptr<common::socket> create_socket(int port);
+
+    /** I/O monitor */
+    std::shared_ptr<common::io_monitor> io_monitor_;
+
+    /** Controller context */
+    std::shared_ptr<common::controller_ctx> ctx_;
+
+    /** Sensor socket */
+    std::shared_ptr<common::socket> socket_;
+
+    /** Chassi microcontroller serial reader (optional) */
+    std::unique_ptr<chassi_status_reader> chassi_reader_;
+
+    /** Timer id of pending serial device reopen */
+    uint64_t chassi_reopen_timer_id_{0};
+
+    /** Chassi alarm as last published */
+    bool chassi_alarm_{false};
+
+    /** Ventilation fan RPM threshold crossings */
+    temperature_hysteresis cabinet_temp_hysteresis_{
+        ventilation_fan_high_rpm_lower_threshold,
+        ventilation_fan_high_rpm_upper_threshold};
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,143 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+/** @file seqlock.hpp
+ * @brief Sequence lock for small, trivially copyable state
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Sequence lock
+ *
+ * Readers never block and never write shared memory: they copy the value and
+ * retry if a writer was active meanwhile. Writers are serialized among
+ * themselves, but never wait for readers. The value is stored as relaxed
+ * atomic words so that a torn read is well defined and simply discarded.
+ */
+template <typename T> class seqlock
+{
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "seqlock value must be trivially copyable");
+
+  public:
+    /** Constructor */
+    seqlock() { store(T{}); }
+
+    /** Copy constructor */
+    seqlock(const seqlock &other) = delete;
+
+    /** Copy assignment operator */
+    seqlock &operator=(const seqlock &other) = delete;
+
+    /** @brief Read consistent snapshot
+     *
+     * @return Copy of the value
+     */
+    T load() const
+    {
+        std::array<uint64_t, nr_words> words{};
+        uint32_t seq_begin = 0;
+        uint32_t seq_end = 0;
+
+        do {
+            seq_begin = seq_.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < nr_words; i++) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq_end = seq_.load(std::memory_order_relaxed);
+        } while ((seq_begin & 1U) != 0 || seq_begin != seq_end);
+
+        // Valid for any trivially copyable T (see static_assert above),
+        // including ones with default member initializers
+        T value;
+        std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    /** @brief Replace value
+     *
+     * @param value  New value
+     */
+    void store(const T &value)
+    {
+        const std::lock_guard<std::mutex> lock(writer_mutex_);
+        write(value);
+    }
+
+    /** @brief Read-modify-write
+     *
+     * Writers updating different fields of the same value do not lose each
+     * other's updates.
+     *
+     * @param f  Invoked with a reference to a copy of the current value
+     */
+    template <typename F> void update(F &&f)
+    {
+        const std::lock_guard<std::mutex> lock(writer_mutex_);
+        T value = load();
+        f(value);
+        write(value);
+    }
+
+  private:
+    /** Number of 64-bit words needed for the value */
+    static constexpr std::size_t nr_words = (sizeof(T) + 7) / 8;
+
+    /** Publish value, writer mutex held */
+    void write(const T &value)
+    {
+        std::array<uint64_t, nr_words> words{};
+        std::memcpy(words.data(), static_cast<const void *>(&value),
+                    sizeof(T));
+
+        uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < nr_words; i++) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /** Sequence number, odd while a write is in progress */
+    std::atomic<uint32_t> seq_{0};
+
+    /** Value storage */
+    std::array<std::atomic<uint64_t>, nr_words> data_{};
+
+    /** Serializes writers */
+    std::mutex writer_mutex_;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -0,0 +1,97 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <charconv>
+
+#include <common/string_processing/scan.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static bool is_key_char(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::string_view scan_value(std::string_view str, std::string_view key)
+{
+    std::size_t pos = str.find(key);
+    while (pos != std::string_view::npos) {
+        if (pos == 0 || !is_key_char(str[pos - 1])) {
+            auto value = str.substr(pos + key.size());
+
+            // Tolerate padding between separator and value
+            auto start = value.find_first_not_of(' ');
+            return start == std::string_view::npos ? std::string_view()
+                                                   : value.substr(start);
+        }
+        pos = str.find(key, pos + 1);
+    }
+
+    return {};
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+bool scan_double(std::string_view str, std::string_view key, double &value)
+{
+    auto text = scan_value(str, key);
+    if (text.empty()) {
+        return false;
+    }
+
+    double result = 0;
+    auto [end, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), result);
+    if (ec != std::errc()) {
+        return false;
+    }
+
+    value = result;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+bool scan_integer(std::string_view str, std::string_view key, int &value)
+{
+    auto text = scan_value(str, key);
+    if (text.empty()) {
+        return false;
+    }
+
+    int result = 0;
+    auto [end, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), result);
+    if (ec != std::errc()) {
+        return false;
+    }
+
+    value = result;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
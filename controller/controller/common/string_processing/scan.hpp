@@ -0,0 +1,71 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#pragma once
+
+/** @file scan.hpp
+ * @brief Allocation free key/value scanning for sensor feeds
+ */
+
+#include <string_view>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Locate the value following a key
+ *
+ * The key must start the string or follow a character that cannot be part of
+ * a key, so that "temp=" does not match inside "cabinet_temp=".
+ *
+ * @param str  Text to scan, e.g. "temp=23.50, humidity=41.00;"
+ * @param key  Key including its separator, e.g. "temp="
+ *
+ * @return Text following the key, empty when the key is missing
+ */
+std::string_view scan_value(std::string_view str, std::string_view key);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Scan floating point value following a key
+ *
+ * @param str    Text to scan
+ * @param key    Key including its separator
+ * @param value  Result, untouched on failure
+ *
+ * @return True when the key is present and followed by a number
+ */
+bool scan_double(std::string_view str, std::string_view key, double &value);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Scan integer value following a key
+ *
+ * @param str    Text to scan
+ * @param key    Key including its separator
+ * @param value  Result, untouched on failure
+ *
+ * @return True when the key is present and followed by a number
+ */
+bool scan_integer(std::string_view str, std::string_view key, int &value);
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
@@ -17,8 +17,8 @@
  */
 
 #include <cstdio>
-#include <cstdlib>
 #include <ctime>
+#include <utility>
 
 #include <common/system_clock.hpp>
 
@@ -27,7 +27,8 @@ namespace common {
 
 //---------------------------------------------------------------------------------------------------------------------
 
-system_clock::system_clock()
+system_clock::system_clock(std::shared_ptr<virtual_clock> vclock)
+    : vclock_(std::move(vclock))
 {
     // Ensure there is no initial transition of hour, minute and seconds
     update();
@@ -42,34 +43,28 @@ void system_clock::update()
     prev_tick_minute_ = minute_;
     prev_tick_second_ = second_;
 
-    time_t now = ::time(0);
-    struct tm tstruct;
-    char buffer[80];
-    tstruct = *localtime(&now);
+    epoch_ = current_epoch();
 
-    // Year
-    strftime(buffer, sizeof(buffer), "%Y", &tstruct);
-    year_ = std::atoi(buffer);
-
-    // Month
-    strftime(buffer, sizeof(buffer), "%m", &tstruct);
-    month_ = std::atoi(buffer);
-
-    // Day
-    strftime(buffer, sizeof(buffer), "%d", &tstruct);
-    day_ = std::atoi(buffer);
+    // Within the current minute only the second changes. Zone offset and
+    // calendar fields are refreshed at minute rollover or on a clock jump.
+    if (epoch_ >= minute_start_ && epoch_ < minute_start_ + 60) {
+        second_ = static_cast<int>(epoch_ - minute_start_);
+        return;
+    }
 
-    // Hour
-    strftime(buffer, sizeof(buffer), "%H", &tstruct);
-    hour_ = std::atoi(buffer);
+    struct tm tstruct
+    {};
+    localtime_r(&epoch_, &tstruct);
 
-    // Minute
-    strftime(buffer, sizeof(buffer), "%M", &tstruct);
-    minute_ = std::atoi(buffer);
+    year_ = tstruct.tm_year + 1900;
+    month_ = tstruct.tm_mon + 1;
+    day_ = tstruct.tm_mday;
+    hour_ = tstruct.tm_hour;
+    minute_ = tstruct.tm_min;
+    second_ = tstruct.tm_sec;
 
-    // Second
-    strftime(buffer, sizeof(buffer), "%S", &tstruct);
-    second_ = std::atoi(buffer);
+    minute_start_ = epoch_ - tstruct.tm_sec;
+    utc_offset_ = tstruct.tm_gmtoff;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -102,10 +97,23 @@ int system_clock::second() { return second_; }
 
 //---------------------------------------------------------------------------------------------------------------------
 
+time_t system_clock::epoch() { return epoch_; }
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::chrono::system_clock::time_point system_clock::next_minute()
+{
+    return std::chrono::system_clock::from_time_t(minute_start_ + 60);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 std::string system_clock::date()
 {
+    struct tm tstruct = now();
     char buffer[128];
-    snprintf(buffer, sizeof(buffer), "%d-%02d-%02d", year_, month_, day_);
+    snprintf(buffer, sizeof(buffer), "%d-%02d-%02d", tstruct.tm_year + 1900,
+             tstruct.tm_mon + 1, tstruct.tm_mday);
     return std::string(buffer);
 }
 
@@ -113,8 +121,10 @@ std::string system_clock::date()
 
 std::string system_clock::time()
 {
+    struct tm tstruct = now();
     char buffer[128];
-    snprintf(buffer, sizeof(buffer), "%02d:%02d", hour_, minute_);
+    snprintf(buffer, sizeof(buffer), "%02d:%02d", tstruct.tm_hour,
+             tstruct.tm_min);
     return std::string(buffer);
 }
 
@@ -122,8 +132,10 @@ std::string system_clock::time()
 
 std::string system_clock::time_full()
 {
+    struct tm tstruct = now();
     char buffer[128];
-    snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", hour_, minute_, second_);
+    snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", tstruct.tm_hour,
+             tstruct.tm_min, tstruct.tm_sec);
     return std::string(buffer);
 }
 
@@ -143,16 +155,39 @@ bool system_clock::second_transition() { return second_ != prev_tick_second_; }
 
 int system_clock::hourly_seconds_remaining()
 {
-    int remaining = 3600;
+    constexpr time_t seconds_per_hour = 3600;
 
-    remaining -= minute_ * 60;
-    remaining -= second_;
+    // Ticks only happen at minute boundaries so the second is computed here
+    time_t local = current_epoch() + utc_offset_;
+    auto remaining = seconds_per_hour - local % seconds_per_hour;
 
-    if (remaining < 0) {
-        remaining = 0;
+    return static_cast<int>(remaining);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+time_t system_clock::current_epoch()
+{
+    if (vclock_ != nullptr) {
+        return std::chrono::system_clock::to_time_t(vclock_->now());
     }
 
-    return remaining;
+    // Not time(), which may use a coarse clock that lags a boundary timer
+    struct timespec ts
+    {};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+struct tm system_clock::now()
+{
+    time_t t = current_epoch();
+    struct tm tstruct
+    {};
+    localtime_r(&t, &tstruct);
+    return tstruct;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
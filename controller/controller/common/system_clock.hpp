@@ -18,8 +18,13 @@
 
 #pragma once
 
+#include <chrono>
+#include <ctime>
+#include <memory>
 #include <string>
 
+#include <common/virtual_clock.hpp>
+
 namespace hydroctrl {
 namespace common {
 
@@ -28,10 +33,18 @@ namespace common {
 class system_clock
 {
   public:
-    /** Constructor */
-    system_clock();
-
-    /** 500 ms timer tick */
+    /** @brief Constructor
+     *
+     * @param vclock  Virtual time source (simulation mode), nullptr for the
+     *                real wall clock
+     */
+    explicit system_clock(std::shared_ptr<virtual_clock> vclock = nullptr);
+
+    /** @brief Timer tick
+     *
+     * Invoked at minute boundaries and when the system clock is set.
+     * Calendar fields and transitions refer to the last tick.
+     */
     void tick();
 
     /** Current year (YYYY) */
@@ -52,6 +65,12 @@ class system_clock
     /** Current second (0-60 including occational leap second) */
     int second();
 
+    /** Seconds since epoch at last tick */
+    time_t epoch();
+
+    /** Start of the minute following the last tick */
+    std::chrono::system_clock::time_point next_minute();
+
     /** Current date YYYY-MM-DD */
     std::string date();
 
@@ -77,6 +96,15 @@ class system_clock
     /** Update */
     void update();
 
+    /** Seconds since epoch */
+    time_t current_epoch();
+
+    /** Current local time */
+    struct tm now();
+
+    /** Virtual time source, nullptr when using the wall clock */
+    std::shared_ptr<virtual_clock> vclock_;
+
     int year_{0};
 
     int month_{0};
@@ -89,6 +117,14 @@ class system_clock
 
     int second_{0};
 
+    time_t epoch_{0};
+
+    /** Epoch of second 0 in the current minute */
+    time_t minute_start_{-1};
+
+    /** Local time zone offset in seconds, refreshed every minute */
+    long utc_offset_{0};
+
     int prev_tick_hour_{0};
 
     int prev_tick_minute_{0};
@@ -76,6 +76,12 @@ struct task
 
     /** Timer id */
     uint64_t timer_id{0};
+
+    /** Wall clock task, expires at 'expiry' instead of after interval */
+    bool wall_clock{false};
+
+    /** Wall clock expiry */
+    std::chrono::system_clock::time_point expiry;
 };
 
 //-------------------------------------------------------------------------------------------------------------------
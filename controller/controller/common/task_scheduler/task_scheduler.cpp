@@ -17,6 +17,7 @@
  */
 
 #include <iostream>
+#include <utility>
 
 #include <common/task_scheduler/task_scheduler.hpp>
 
@@ -25,16 +26,21 @@ namespace common {
 
 //-------------------------------------------------------------------------------------------------------------------
 
-std::shared_ptr<task_scheduler_interface> create_task_scheduler()
+std::shared_ptr<task_scheduler_interface>
+create_task_scheduler(std::shared_ptr<virtual_clock> vclock)
 {
-    return std::make_shared<task_scheduler>();
+    return std::make_shared<task_scheduler>(std::move(vclock));
 }
 
 //-------------------------------------------------------------------------------------------------------------------
 
-task_scheduler::task_scheduler()
+task_scheduler::task_scheduler(std::shared_ptr<virtual_clock> vclock)
+    : vclock_(std::move(vclock))
 {
-    io_monitor_ = std::make_shared<common::io_monitor>(common::io_monitor());
+    if (vclock_ == nullptr) {
+        io_monitor_ =
+            std::make_shared<common::io_monitor>(common::io_monitor());
+    }
 }
 
 //-------------------------------------------------------------------------------------------------------------------
@@ -90,6 +96,25 @@ task_scheduler::register_periodic_task(std::chrono::milliseconds interval,
 
 //-------------------------------------------------------------------------------------------------------------------
 
+task_id task_scheduler::register_wall_clock_task(
+    std::chrono::system_clock::time_point expiry,
+    std::function<void(task_context)> cb)
+{
+    auto tsk = create_task(std::chrono::milliseconds(0), cb);
+
+    constexpr uint64_t iterations_single_task = 1;
+    tsk->ctx.total_iterations = iterations_single_task;
+    tsk->wall_clock = true;
+    tsk->expiry = expiry;
+    create_timer(tsk);
+
+    auto id = tsk->ctx.id;
+    task_map_[id] = tsk;
+    return id;
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+
 void task_scheduler::cancel_task(task_id tid, cancel_info cancel_behaviour)
 {
     if (task_map_.find(tid) == task_map_.end()) {
@@ -168,6 +193,7 @@ task_scheduler::create_task(std::chrono::milliseconds interval,
 void task_scheduler::invoke_callback(std::shared_ptr<task> tsk)
 {
     tsk->ctx.timestamp = std::chrono::steady_clock::now();
+    nr_callbacks_++;
 
     // Invoke std::bind() object while providing
     // std::placeholders::_1 with task context
@@ -185,6 +211,11 @@ void task_scheduler::invoke_callback(std::shared_ptr<task> tsk)
 
 void task_scheduler::run_foreground_scheduler(task_scheduler_mode mode)
 {
+    if (vclock_ != nullptr) {
+        run_virtual_scheduler();
+        return;
+    }
+
     while (true) {
         auto events = io_monitor_->wait_for_events();
 
@@ -203,27 +234,7 @@ void task_scheduler::run_foreground_scheduler(task_scheduler_mode mode)
 
                     auto timer_event =
                         std::dynamic_pointer_cast<common::timer_event>(event);
-                    auto timer_id = timer_event->get_id();
-
-                    auto tsk = lookup_task_from_timer(timer_id);
-                    if (tsk != nullptr) {
-                        tsk->ctx.current_iterations++;
-                        if ((tsk->ctx.total_iterations != 0 &&
-                             tsk->ctx.current_iterations >=
-                                 tsk->ctx.total_iterations) ||
-                            tsk->ctx.graceful_cancellation) {
-                            tsk->ctx.last_callback = true;
-                            destroy_timer(tsk);
-                        }
-
-                        invoke_callback(tsk);
-
-                        if (tsk->ctx.last_callback) {
-                            task_map_.erase(tsk->ctx.id);
-                        } else {
-                            create_timer(tsk);
-                        }
-                    }
+                    handle_timer_event(timer_event->get_id());
                 }
             }
         } catch (const std::system_error &ex) {
@@ -234,8 +245,66 @@ void task_scheduler::run_foreground_scheduler(task_scheduler_mode mode)
 
 //-------------------------------------------------------------------------------------------------------------------
 
+void task_scheduler::run_virtual_scheduler()
+{
+    // Jump to the earliest deadline instead of waiting for it. Timers with
+    // equal deadlines expire in registration order.
+    while (!exit_ && !virtual_timers_.empty()) {
+        auto it = virtual_timers_.begin();
+        auto deadline = it->first;
+        auto timer_id = it->second;
+        virtual_timers_.erase(it);
+
+        vclock_->advance_to(deadline);
+        handle_timer_event(timer_id);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+
+void task_scheduler::handle_timer_event(uint64_t timer_id)
+{
+    auto tsk = lookup_task_from_timer(timer_id);
+    if (tsk == nullptr) {
+        return;
+    }
+
+    tsk->ctx.current_iterations++;
+    if ((tsk->ctx.total_iterations != 0 &&
+         tsk->ctx.current_iterations >= tsk->ctx.total_iterations) ||
+        tsk->ctx.graceful_cancellation) {
+        tsk->ctx.last_callback = true;
+        destroy_timer(tsk);
+    }
+
+    invoke_callback(tsk);
+
+    if (tsk->ctx.last_callback) {
+        task_map_.erase(tsk->ctx.id);
+    } else {
+        create_timer(tsk);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------
+
 void task_scheduler::create_timer(std::shared_ptr<task> tsk)
 {
+    if (vclock_ != nullptr) {
+        auto deadline = tsk->wall_clock ? tsk->expiry
+                                        : vclock_->now() + tsk->ctx.interval;
+        tsk->timer_id = ++virtual_timer_id_;
+        virtual_timers_.emplace(deadline, tsk->timer_id);
+        timer_map_[tsk->timer_id] = tsk->ctx.id;
+        return;
+    }
+
+    if (tsk->wall_clock) {
+        tsk->timer_id = io_monitor_->register_wall_clock_timer(tsk->expiry);
+        timer_map_[tsk->timer_id] = tsk->ctx.id;
+        return;
+    }
+
     auto duration = std::chrono::microseconds(tsk->ctx.interval.count() * 1000);
     tsk->timer_id = io_monitor_->register_one_shot_timer(duration);
 
@@ -274,5 +343,9 @@ void task_scheduler::teardown() { exit_ = true; }
 
 //-------------------------------------------------------------------------------------------------------------------
 
+uint64_t task_scheduler::nr_callbacks() { return nr_callbacks_; }
+
+//-------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
 } // namespace hydroctrl
\ No newline at end of file
@@ -22,9 +22,12 @@
  *  @brief Windows task scheduler, implementing the task scheduler interface
  */
 
+#include <map>
+
 #include <common/io_monitor.hpp>
 #include <common/task_scheduler/task.hpp>
 #include <common/task_scheduler/task_scheduler_interface.hpp>
+#include <common/virtual_clock.hpp>
 
 namespace hydroctrl {
 namespace common {
@@ -35,7 +38,12 @@ namespace common {
 class task_scheduler : public task_scheduler_interface
 {
   public:
-    task_scheduler();
+    /** @brief Constructor
+     *
+     * @param vclock  Virtual time source (simulation mode), nullptr for
+     *                timerfd based scheduling in real time
+     */
+    explicit task_scheduler(std::shared_ptr<virtual_clock> vclock = nullptr);
 
     /** @brief Register single task
      *
@@ -82,6 +90,21 @@ class task_scheduler : public task_scheduler_interface
                                    size_t nr_iterations,
                                    std::function<void(task_context)> cb) final;
 
+    /** @brief Register wall clock task
+     *
+     * See task_scheduler_interface::register_wall_clock_task() description
+     * for more information.
+     *
+     * @param expiry     Absolute wall clock time
+     * @param cb         Function wrapper containing std::bind() object for the
+     * callback. It is assumed that the application adds an user_data parameter
+     *                   after the task_context to be able to handle the
+     * callback.
+     */
+    task_id
+    register_wall_clock_task(std::chrono::system_clock::time_point expiry,
+                             std::function<void(task_context)> cb) final;
+
     /** @brief  Cancel ongoing task
      *
      * See task_scheduler_interface::cancel_task() description for more
@@ -117,10 +140,19 @@ class task_scheduler : public task_scheduler_interface
      */
     void teardown() final;
 
+    /** Number of callbacks invoked so far */
+    uint64_t nr_callbacks() final;
+
   private:
     /** Helper function for foreground scheduling loop */
     void run_foreground_scheduler(task_scheduler_mode mode);
 
+    /** Helper function for scheduling loop in virtual time */
+    void run_virtual_scheduler();
+
+    /** Helper function for expired task timer */
+    void handle_timer_event(uint64_t timer_id);
+
     /** Helpder function for creating task */
     std::shared_ptr<task> create_task(std::chrono::milliseconds interval,
                                       std::function<void(task_context)> cb);
@@ -163,6 +195,23 @@ class task_scheduler : public task_scheduler_interface
 
     /** Exit flag */
     bool exit_{false};
+
+    /** Number of invoked callbacks */
+    uint64_t nr_callbacks_{0};
+
+    /** Virtual time source, nullptr when running in real time */
+    std::shared_ptr<virtual_clock> vclock_;
+
+    /** Last virtual timer id */
+    uint64_t virtual_timer_id_{0};
+
+    /** @brief Virtual timers
+     *
+     * Key: Deadline
+     * Value: Timer identifier
+     */
+    std::multimap<std::chrono::system_clock::time_point, uint64_t>
+        virtual_timers_;
 };
 
 //-------------------------------------------------------------------------------------------------------------------
@@ -154,6 +154,8 @@
 namespace hydroctrl {
 namespace common {
 
+class virtual_clock;
+
 //-------------------------------------------------------------------------------------------------------------------
 
 /** Task scheduler interface */
@@ -212,6 +214,24 @@ class task_scheduler_interface
                            size_t nr_iterations,
                            std::function<void(task_context)> cb) = 0;
 
+    /** @brief Register wall clock task
+     *
+     * This method instructs the scheduler to invoke the callback
+     * a single time when the system clock reaches the given time
+     * point. The callback is invoked early if the system clock is
+     * set, so the application must check the time and register a
+     * new task when needed.
+     *
+     * @param expiry     Absolute wall clock time
+     * @param cb         Function wrapper containing std::bind() object for the
+     * callback. It is assumed that the application adds an user_data parameter
+     *                   after the task_context to be able to handle the
+     * callback.
+     */
+    virtual task_id
+    register_wall_clock_task(std::chrono::system_clock::time_point expiry,
+                             std::function<void(task_context)> cb) = 0;
+
     /** @brief Cancel ongoing task
      *
      * If the given tid is currently scheduled it is cancelled. Invalid
@@ -253,6 +273,12 @@ class task_scheduler_interface
      * invoked it is returning.
      */
     virtual void teardown() = 0;
+
+    /** @brief Number of callbacks invoked so far
+     *
+     * Used for measuring scheduler throughput.
+     */
+    virtual uint64_t nr_callbacks() = 0;
 };
 
 //-------------------------------------------------------------------------------------------------------------------
@@ -260,8 +286,12 @@ class task_scheduler_interface
 /** @brief Create task scheduler
  *
  * This returns an allocated task scheduler.
+ *
+ * @param vclock  Virtual time source. When given, the scheduler jumps to the
+ *                next deadline instead of waiting for it (simulation mode).
  */
-std::shared_ptr<task_scheduler_interface> create_task_scheduler();
+std::shared_ptr<task_scheduler_interface>
+create_task_scheduler(std::shared_ptr<virtual_clock> vclock = nullptr);
 
 //-------------------------------------------------------------------------------------------------------------------
 
@@ -40,5 +40,29 @@ std::string ventilation_fan_mode_str(ventilation_fan_mode mode)
 
 //---------------------------------------------------------------------------------------------------------------------
 
+temperature_hysteresis::temperature_hysteresis(double lower_threshold,
+                                               double upper_threshold)
+    : lower_threshold_(lower_threshold), upper_threshold_(upper_threshold)
+{}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+temperature_crossing temperature_hysteresis::update(double value)
+{
+    if (!high_ && value > upper_threshold_) {
+        high_ = true;
+        return temperature_crossing::rising;
+    }
+
+    if (high_ && value < lower_threshold_) {
+        high_ = false;
+        return temperature_crossing::falling;
+    }
+
+    return temperature_crossing::none;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
 } // namespace hydroctrl
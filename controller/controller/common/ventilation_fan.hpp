@@ -65,5 +65,57 @@ constexpr double ventilation_fan_high_rpm_lower_threshold = 30;
 
 //---------------------------------------------------------------------------------------------------------------------
 
+/** Temperature threshold crossing */
+enum class temperature_crossing
+{
+    /** No crossing */
+    none,
+
+    /** Temperature exceeded upper threshold */
+    rising,
+
+    /** Temperature dropped below lower threshold */
+    falling,
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** @brief Temperature hysteresis
+ *
+ * Turns a stream of temperature samples into threshold crossings. A rising
+ * crossing is only reported again after a falling one, so noise around a
+ * single threshold does not produce a burst of events.
+ */
+class temperature_hysteresis
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param lower_threshold  Falling crossing below this value
+     * @param upper_threshold  Rising crossing above this value
+     */
+    temperature_hysteresis(double lower_threshold, double upper_threshold);
+
+    /** @brief Feed sample
+     *
+     * @param value  Temperature sample
+     *
+     * @return Crossing caused by this sample, if any
+     */
+    temperature_crossing update(double value);
+
+  private:
+    /** Lower threshold */
+    double lower_threshold_{0};
+
+    /** Upper threshold */
+    double upper_threshold_{0};
+
+    /** Last crossing was rising */
+    bool high_{false};
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
 } // namespace common
 } // namespace hydroctrl
@@ -0,0 +1,47 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <common/virtual_clock.hpp>
+
+namespace hydroctrl {
+namespace common {
+
+//---------------------------------------------------------------------------------------------------------------------
+
+virtual_clock::virtual_clock(std::chrono::system_clock::time_point start)
+    : now_(start)
+{}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+std::chrono::system_clock::time_point virtual_clock::now() { return now_; }
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void virtual_clock::advance_to(std::chrono::system_clock::time_point tp)
+{
+    if (tp > now_) {
+        now_ = tp;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+} // namespace common
+} // namespace hydroctrl
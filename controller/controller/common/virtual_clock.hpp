@@ -16,42 +16,49 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+
 #pragma once
 
-#include <memory>
-#include <vector>
+/** @file virtual_clock.hpp
+ * @brief Virtual time source for simulation mode
+ */
 
-#include <common/channel/channel.hpp>
-#include <common/channel/subsystem/main/full_spectrum_light_channel.hpp>
-#include <common/channel/subsystem/main/ventilation_fan_channel.hpp>
-#include <common/channel/subsystem/main/wind_simulation_fan_channel.hpp>
-#include <common/channel/subsystem/main/drip_irrigation_channel.hpp>
+#include <chrono>
 
 namespace hydroctrl {
 namespace common {
 
 //---------------------------------------------------------------------------------------------------------------------
 
-/** Channel collection */
-struct channel_collection
+/** @brief Virtual clock
+ *
+ * Replaces the wall clock and the monotonic clock in simulation mode. Time
+ * only moves when the task scheduler advances it to the next deadline, so
+ * weeks of channel behaviour can be replayed in seconds.
+ */
+class virtual_clock
 {
-    /** Upper full spectrum light channel */
-    std::shared_ptr<full_spectrum_light_channel> upper_full_spectrum_light;
-
-    /** Lower full spectrum light channel */
-    std::shared_ptr<full_spectrum_light_channel> lower_full_spectrum_light;
-
-    /** Drip irrigation channel */
-    std::shared_ptr<drip_irrigation_channel> drip_irrigation;
+  public:
+    /** @brief Constructor
+     *
+     * @param start  Initial wall clock time
+     */
+    explicit virtual_clock(std::chrono::system_clock::time_point start);
 
-    /** Ventilation fan channel */
-    std::shared_ptr<ventilation_fan_channel> ventilation_fan;
+    /** Current virtual wall clock time */
+    std::chrono::system_clock::time_point now();
 
-    /** Wind simulation channel */
-    std::shared_ptr<wind_simulation_fan_channel> wind_simulation_fan;
+    /** @brief Advance time
+     *
+     * Time never moves backwards; earlier time points are ignored.
+     *
+     * @param tp  New time
+     */
+    void advance_to(std::chrono::system_clock::time_point tp);
 
-    /** Iterator friendly vector */
-    std::vector<std::shared_ptr<channel>> all_channels;
+  private:
+    /** Current time */
+    std::chrono::system_clock::time_point now_;
 };
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -16,9 +16,13 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <random>
 #include <thread>
 
-#include <common/channel_index.hpp>
 #include <common/string_processing/regex.hpp>
 #include <controller/controller.hpp>
 #include <user_interface/socket_user_interface/request_handler.hpp>
@@ -28,6 +32,33 @@ namespace controller {
 
 //---------------------------------------------------------------------------------------------------------------------
 
+/** @brief Local midnight of simulation start date
+ *
+ * @param date  YYYY-MM-DD, empty for today
+ */
+static std::chrono::system_clock::time_point
+simulation_start_time(const std::string &date)
+{
+    struct tm tstruct
+    {};
+
+    if (date.empty()) {
+        time_t now = ::time(nullptr);
+        localtime_r(&now, &tstruct);
+    } else {
+        strptime(date.c_str(), "%Y-%m-%d", &tstruct);
+    }
+
+    tstruct.tm_hour = 0;
+    tstruct.tm_min = 0;
+    tstruct.tm_sec = 0;
+    tstruct.tm_isdst = -1;
+
+    return std::chrono::system_clock::from_time_t(mktime(&tstruct));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 controller::controller(std::shared_ptr<common::configuration> cfg)
 {
     /******************************************************************************************/
@@ -36,10 +67,23 @@ controller::controller(std::shared_ptr<common::configuration> cfg)
     ctx_ = std::make_shared<common::controller_ctx>();
     ctx_->mutex = std::make_shared<std::mutex>();
     ctx_->config = cfg;
-    ctx_->clock = std::make_shared<common::system_clock>();
-    ctx_->relay_module = std::make_shared<common::relay_module>();
 
-    ctx_->task_scheduler = common::create_task_scheduler();
+    // Simulation mode: virtual time, simulated relays and a seeded random
+    // engine, so that a replay with the same seed and start date is identical
+    if (cfg->simulation_days > 0) {
+        vclock_ = std::make_shared<common::virtual_clock>(
+            simulation_start_time(cfg->simulation_start));
+        ctx_->relay_module = std::make_shared<common::relay_module>(
+            vclock_, common::relay_module_size + cfg->simulation_channels);
+        ctx_->random_engine.seed(cfg->simulation_seed);
+    } else {
+        ctx_->relay_module = std::make_shared<common::relay_module>();
+        ctx_->random_engine.seed(std::random_device()());
+    }
+
+    ctx_->clock = std::make_shared<common::system_clock>(vclock_);
+
+    ctx_->task_scheduler = common::create_task_scheduler(vclock_);
     ctx_->task_scheduler->set_mutex(ctx_->mutex);
 
     auto f1 = std::bind(&user_request_set_ventilation_fan_mode,
@@ -59,61 +103,55 @@ controller::controller(std::shared_ptr<common::configuration> cfg)
     ctx_->user_request_development_cmd =
         std::make_shared<std::function<void(std::string)>>(f3);
 
-    request_handler_ =
-        std::make_shared<user_interface::request_handler>(cfg, ctx_);
-
-    channel_collection_ = std::make_shared<common::channel_collection>();
-
-    auto ch_a0 = std::make_shared<common::ventilation_fan_channel>(ctx_);
-    // At the moment, rpm modes are disabled; vector has two identical entries
-    std::vector<int> relay_indexes;
-    relay_indexes.emplace_back(
-        common::relay_channel_idx_ventilation_fan_channel_high_rpm);
-    relay_indexes.emplace_back(
-        common::relay_channel_idx_ventilation_fan_channel_high_rpm);
-    ch_a0->set_relay_module_idx(relay_indexes);
-    channel_collection_->ventilation_fan = ch_a0;
-    channel_collection_->all_channels.emplace_back(ch_a0);
-
-    auto ch_a1 = std::make_shared<common::full_spectrum_light_channel>(
-        common::channel_type::upper_full_spectrum_light, ctx_);
-    ch_a1->set_relay_module_idx(
-        common::relay_channel_idx_upper_full_spectrum_light_channel);
-    channel_collection_->upper_full_spectrum_light = ch_a1;
-    channel_collection_->all_channels.emplace_back(ch_a1);
-
-    auto ch_a2 = std::make_shared<common::full_spectrum_light_channel>(
-        common::channel_type::lower_full_spectrum_light, ctx_);
-    ch_a2->set_relay_module_idx(
-        common::relay_channel_idx_lower_full_spectrum_light_channel);
-    channel_collection_->lower_full_spectrum_light = ch_a2;
-    channel_collection_->all_channels.emplace_back(ch_a2);
-
-    auto ch_a3 = std::make_shared<common::wind_simulation_fan_channel>(
-        common::channel_type::wind_simulation_fan, ctx_);
-    ch_a3->set_relay_module_idx(
-        common::relay_channel_idx_wind_simulation_fan_channel);
-    channel_collection_->wind_simulation_fan = ch_a3;
-    channel_collection_->all_channels.emplace_back(ch_a3);
-
-    auto ch_a4 = std::make_shared<common::drip_irrigation_channel>(
-        common::channel_type::drip_irrigation, ctx_);
-    ch_a4->set_relay_module_idx(
-        common::relay_channel_idx_drip_irrigation_channel);
-    channel_collection_->drip_irrigation = ch_a4;
-    channel_collection_->all_channels.emplace_back(ch_a4);
+    auto f4 = std::bind(&cabinet_temperature_crossing_cb, std::placeholders::_1,
+                        this);
+    ctx_->cabinet_temperature_crossing =
+        std::make_shared<std::function<void(common::temperature_crossing)>>(
+            f4);
+
+    // No sockets or serial device in simulation mode
+    if (vclock_ == nullptr) {
+        request_handler_ =
+            std::make_shared<user_interface::request_handler>(cfg, ctx_);
+
+        sensor_ingest_ = std::make_shared<common::sensor_ingest>(cfg, ctx_);
+    }
+
+    channel_registry_ = std::make_shared<common::channel_registry>(ctx_);
+    for (auto &&def : cfg->channels) {
+        channel_registry_->add(def);
+    }
+
+    if (vclock_ != nullptr) {
+        add_simulated_channels(cfg->simulation_channels);
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 
-void controller::refresh_transformer_state(controller *_this)
+void controller::add_simulated_channels(int nr_channels)
 {
-    auto channel_collection = _this->channel_collection_;
-
+    const std::array<common::channel_type, 3> types = {
+        common::channel_type::upper_full_spectrum_light,
+        common::channel_type::wind_simulation_fan,
+        common::channel_type::drip_irrigation};
+
+    // Relays beyond the physical module, one per channel
+    for (int i = 0; i < nr_channels; i++) {
+        common::channel_definition def;
+        def.name = "simulated_" + std::to_string(i);
+        def.type = types[i % types.size()];
+        def.relay_indexes.emplace_back(common::relay_module_size + i);
+        channel_registry_->add(def);
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 
+void controller::refresh_transformer_state(controller *) {}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 void controller::user_request_development_cmd(std::string cmd,
                                               controller *_this)
 {
@@ -121,14 +159,28 @@ void controller::user_request_development_cmd(std::string cmd,
 
     if (cmd.find("development_cmd_cabinet_temperature_low") !=
         std::string::npos) {
-        ctx->cabinet_status.cabinet_temperature =
-            common::temperature(common::temperature::temp_unit::celcius, 20);
+        ctx->cabinet_status.update([](common::cabinet_measurements &cabinet) {
+            cabinet.cabinet_temperature = common::temperature(
+                common::temperature::temp_unit::celcius, 20);
+        });
     }
 
     else if (cmd.find("development_cmd_cabinet_temperature_high") !=
              std::string::npos) {
-        ctx->cabinet_status.cabinet_temperature =
-            common::temperature(common::temperature::temp_unit::celcius, 43);
+        ctx->cabinet_status.update([](common::cabinet_measurements &cabinet) {
+            cabinet.cabinet_temperature = common::temperature(
+                common::temperature::temp_unit::celcius, 43);
+        });
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void controller::cabinet_temperature_crossing_cb(
+    common::temperature_crossing crossing, controller *_this)
+{
+    for (auto &&fan : _this->ventilation_fans()) {
+        fan->cabinet_temperature_crossing(crossing);
     }
 }
 
@@ -137,8 +189,9 @@ void controller::user_request_development_cmd(std::string cmd,
 void controller::user_request_set_ventilation_fan_mode(
     common::ventilation_fan_mode fan_mode, controller *_this)
 {
-    auto channel_collection = _this->channel_collection_;
-    channel_collection->ventilation_fan->set_fan_mode(fan_mode);
+    for (auto &&fan : _this->ventilation_fans()) {
+        fan->set_fan_mode(fan_mode);
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -147,62 +200,37 @@ void controller::user_request_set_power_profile(
     common::channel_type channel_type,
     common::power_consumption_profile power_profile, controller *_this)
 {
-    auto channel_collection = _this->channel_collection_;
+    auto channel_registry = _this->channel_registry_;
 
-    switch (channel_type) {
-    case common::channel_type::ventilation_fan:
-        channel_collection->ventilation_fan->set_power_consumption_profile(
-            power_profile);
-
-        if (power_profile == common::power_consumption_profile::off) {
-            channel_collection->ventilation_fan->deactivate();
-        } else {
-            channel_collection->ventilation_fan->activate();
-        }
-        break;
-    case common::channel_type::upper_full_spectrum_light:
-        channel_collection->upper_full_spectrum_light
-            ->set_power_consumption_profile(power_profile);
-
-        if (power_profile == common::power_consumption_profile::off) {
-            channel_collection->upper_full_spectrum_light->deactivate();
-        } else {
-            channel_collection->upper_full_spectrum_light->activate();
-        }
-        break;
-    case common::channel_type::lower_full_spectrum_light:
-        channel_collection->lower_full_spectrum_light
-            ->set_power_consumption_profile(power_profile);
+    for (auto idx : channel_registry->indexes_of(channel_type)) {
+        auto ch = channel_registry->at(idx);
+        ch->set_power_consumption_profile(power_profile);
 
         if (power_profile == common::power_consumption_profile::off) {
-            channel_collection->lower_full_spectrum_light->deactivate();
+            ch->deactivate();
         } else {
-            channel_collection->lower_full_spectrum_light->activate();
+            ch->activate();
         }
-        break;
-    case common::channel_type::wind_simulation_fan:
-        channel_collection->wind_simulation_fan->set_power_consumption_profile(
-            power_profile);
+    }
+}
 
-        if (power_profile == common::power_consumption_profile::off) {
-            channel_collection->wind_simulation_fan->deactivate();
-        } else {
-            channel_collection->wind_simulation_fan->activate();
-        }
-        break;
-    case common::channel_type::drip_irrigation:
-        channel_collection->drip_irrigation->set_power_consumption_profile(
-            power_profile);
+//---------------------------------------------------------------------------------------------------------------------
 
-        if (power_profile == common::power_consumption_profile::off) {
-            channel_collection->drip_irrigation->deactivate();
-        } else {
-            channel_collection->drip_irrigation->activate();
+std::vector<std::shared_ptr<common::ventilation_fan_channel>>
+controller::ventilation_fans()
+{
+    std::vector<std::shared_ptr<common::ventilation_fan_channel>> fans;
+
+    for (auto idx :
+         channel_registry_->indexes_of(common::channel_type::ventilation_fan)) {
+        auto fan = std::dynamic_pointer_cast<common::ventilation_fan_channel>(
+            channel_registry_->at(idx));
+        if (fan != nullptr) {
+            fans.emplace_back(fan);
         }
-        break;
-    default:
-        break;
     }
+
+    return fans;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -211,9 +239,10 @@ void controller::system_clock_tick_cb(common::task_context task_ctx,
                                       controller *_this)
 {
     auto clock = _this->ctx_->clock;
-    auto channel_collection = _this->channel_collection_;
+    auto channel_registry = _this->channel_registry_;
 
     clock->tick();
+    register_system_clock_timer(_this);
 
     // New hour trigger point
     if (clock->hour_transition()) {
@@ -221,7 +250,7 @@ void controller::system_clock_tick_cb(common::task_context task_ctx,
         refresh_transformer_state(_this);
 
         // Hourly tick
-        for (auto &&ch : channel_collection->all_channels) {
+        for (auto &&ch : channel_registry->channels()) {
             ch->hourly_tick();
         }
     }
@@ -235,6 +264,78 @@ void controller::system_clock_tick_cb(common::task_context task_ctx,
 
 //---------------------------------------------------------------------------------------------------------------------
 
+void controller::register_system_clock_timer(controller *_this)
+{
+    // Hour boundaries are minute boundaries. A clock change (date --set, NTP
+    // step) triggers the callback early and the timer is armed again.
+    auto bf = std::bind(&system_clock_tick_cb, std::placeholders::_1, _this);
+    _this->ctx_->task_scheduler->register_wall_clock_task(
+        _this->ctx_->clock->next_minute(), bf);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void controller::simulation_end_cb(common::task_context, controller *_this)
+{
+    _this->ctx_->task_scheduler->teardown();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+void controller::run_simulation()
+{
+    auto cfg = ctx_->config;
+    auto channel_registry = channel_registry_;
+
+    // Power profiles are normally set through the user interface. Simulated
+    // channels cycle through the profiles to spread the load.
+    const std::vector<common::power_consumption_profile> profiles = {
+        common::power_consumption_profile::high,
+        common::power_consumption_profile::medium,
+        common::power_consumption_profile::low};
+
+    auto nr_channels = channel_registry->size();
+    auto nr_hw_channels =
+        nr_channels - static_cast<size_t>(cfg->simulation_channels);
+
+    for (size_t i = 0; i < nr_channels; i++) {
+        auto ch = channel_registry->at(i);
+        auto profile = common::power_consumption_profile::medium;
+        if (i >= nr_hw_channels) {
+            profile = profiles[i % profiles.size()];
+        }
+
+        ch->set_power_consumption_profile(profile);
+        ch->activate();
+    }
+
+    register_system_clock_timer(this);
+
+    auto start = vclock_->now();
+    auto start_date = ctx_->clock->date();
+    auto end = start + std::chrono::days(cfg->simulation_days);
+    auto bf = std::bind(&simulation_end_cb, std::placeholders::_1, this);
+    ctx_->task_scheduler->register_wall_clock_task(end, bf);
+
+    auto tp_start = std::chrono::steady_clock::now();
+    ctx_->task_scheduler->run(common::task_scheduler_mode::foreground);
+    auto elapsed = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - tp_start)
+                       .count();
+
+    auto nr_callbacks = ctx_->task_scheduler->nr_callbacks();
+
+    std::cout << ctx_->relay_module->stats();
+    printf("Simulated %d days from %s with %zu channels (seed %u)\n",
+           cfg->simulation_days, start_date.c_str(), nr_channels,
+           cfg->simulation_seed);
+    printf("%llu callbacks in %.3f s (%.0f callbacks/s)\n",
+           static_cast<unsigned long long>(nr_callbacks), elapsed,
+           elapsed > 0 ? static_cast<double>(nr_callbacks) / elapsed : 0.0);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 void controller::task_scheduler_thread_main(controller *_this)
 {
     auto task_scheduler = _this->ctx_->task_scheduler;
@@ -251,21 +352,34 @@ void controller::socket_user_interface_thread_main(controller *_this)
 
 //---------------------------------------------------------------------------------------------------------------------
 
+void controller::sensor_ingest_thread_main(controller *_this)
+{
+    auto sensor_ingest = _this->sensor_ingest_;
+    sensor_ingest->run();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 void controller::run()
 {
+    if (vclock_ != nullptr) {
+        run_simulation();
+        return;
+    }
+
     // Setup system clock timer
-    auto bf = std::bind(&system_clock_tick_cb, std::placeholders::_1, this);
-    auto tid = ctx_->task_scheduler->register_periodic_task(
-        std::chrono::milliseconds(500), bf);
+    register_system_clock_timer(this);
 
     // Setup threads
     auto task_scheduler_thread = std::thread(task_scheduler_thread_main, this);
     auto socket_user_interface_thread =
         std::thread(socket_user_interface_thread_main, this);
+    auto sensor_ingest_thread = std::thread(sensor_ingest_thread_main, this);
 
     // Wait for threads exit
     task_scheduler_thread.join();
     socket_user_interface_thread.join();
+    sensor_ingest_thread.join();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -20,9 +20,12 @@
 
 #include <memory>
 
-#include <common/channel_collection.hpp>
+#include <common/channel/subsystem/main/ventilation_fan_channel.hpp>
+#include <common/channel_registry.hpp>
 #include <common/configuration.hpp>
 #include <common/controller_ctx.hpp>
+#include <common/sensor/sensor_ingest.hpp>
+#include <common/virtual_clock.hpp>
 #include <user_interface/socket_user_interface/request_handler.hpp>
 
 namespace hydroctrl {
@@ -41,12 +44,27 @@ class controller
     static void system_clock_tick_cb(common::task_context task_ctx,
                                      controller *_this);
 
+    static void register_system_clock_timer(controller *_this);
+
+    static void simulation_end_cb(common::task_context task_ctx,
+                                  controller *_this);
+
+    void add_simulated_channels(int nr_channels);
+
+    /** Registered ventilation fan channels */
+    std::vector<std::shared_ptr<common::ventilation_fan_channel>>
+    ventilation_fans();
+
+    void run_simulation();
+
     static void task_scheduler_thread_main(controller *_this);
 
     static void socket_user_interface_thread_main(controller *_this);
 
     static void serial_console_thread_main(controller *_this);
 
+    static void sensor_ingest_thread_main(controller *_this);
+
     static void refresh_transformer_state(controller *_this);
 
     static void
@@ -60,11 +78,20 @@ class controller
     static void user_request_development_cmd(std::string cmd,
                                              controller *_this);
 
+    static void
+    cabinet_temperature_crossing_cb(common::temperature_crossing crossing,
+                                    controller *_this);
+
     std::shared_ptr<common::controller_ctx> ctx_{nullptr};
 
-    std::shared_ptr<common::channel_collection> channel_collection_{nullptr};
+    std::shared_ptr<common::channel_registry> channel_registry_{nullptr};
 
     std::shared_ptr<user_interface::request_handler> request_handler_{nullptr};
+
+    std::shared_ptr<common::sensor_ingest> sensor_ingest_{nullptr};
+
+    /** Virtual time source, only set in simulation mode */
+    std::shared_ptr<common::virtual_clock> vclock_{nullptr};
 };
 
 //---------------------------------------------------------------------------------------------------------------------
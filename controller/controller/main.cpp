@@ -19,6 +19,7 @@
 #include <cstdio>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 
 #include <controller/controller.hpp>
 #include <user_interface/console_user_interface/cli.hpp>
@@ -34,6 +35,34 @@ static void print_help()
                  "Printed to stderr. Default: "
               << static_cast<int>(hydroctrl::common::log_level_default)
               << std::endl;
+    std::cout << " -s --sensor-port=INTEGER          Loopback UDP port for "
+                 "sensor readings relayed by hydro_sensor_service. Default: "
+              << hydroctrl::common::configuration().sensor_ingest_port
+              << std::endl;
+    std::cout << " -d --serial-device=PATH           Chassi microcontroller "
+                 "serial device, empty to disable. Default: "
+              << hydroctrl::common::configuration().chassi_serial_device
+              << std::endl;
+    std::cout << " -c --channels=PATH                Channel definition "
+                 "file, one '<name> <type> <relay>[,<relay>...]' per line. "
+                 "Default: built-in chassi layout"
+              << std::endl;
+    std::cout << " -b --log-benchmark                Measure log statement "
+                 "overhead and exit"
+              << std::endl;
+    std::cout << "    --simulate=DAYS               Replay DAYS of channel "
+                 "behaviour in virtual time without hardware access and exit"
+              << std::endl;
+    std::cout << "    --simulation-start=DATE       Simulation start date "
+                 "(YYYY-MM-DD). Default: today"
+              << std::endl;
+    std::cout << "    --simulation-seed=INTEGER     Random seed for channel "
+                 "start delays. Default: "
+              << hydroctrl::common::configuration().simulation_seed
+              << std::endl;
+    std::cout << "    --simulation-channels=INTEGER Additional simulated "
+                 "channels. Default: 0"
+              << std::endl;
     std::cout << " -h --help                         This help screen"
               << std::endl;
     std::cout << std::endl;
@@ -58,8 +87,23 @@ int main(int argc, char *argv[])
 
     hydroctrl::common::set_log_level(cfg->log_level);
 
-    auto ctrl = hydroctrl::controller::controller(cfg);
-    ctrl.run();
+    // Measure logging overhead and exit
+    if (cfg->log_benchmark) {
+        hydroctrl::common::log_benchmark();
+        return EXIT_SUCCESS;
+    }
+
+    // Channel definitions are checked against the relay module when the
+    // channels are created
+    std::unique_ptr<hydroctrl::controller::controller> ctrl;
+    try {
+        ctrl = std::make_unique<hydroctrl::controller::controller>(cfg);
+    } catch (const std::runtime_error &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ctrl->run();
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,322 @@
+/*
+ *  Hydrotopia
+ *  Copyright (C) 2022 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+/** @file chassi_status_reader_test.cpp
+ * @brief Chassi serial input over a pseudo terminal
+ *
+ * The test plays the chassi microcontroller on the master side of a pty.
+ * The device path is a symlink to the slave side, like a udev
+ * /dev/serial/by-id link, so that a reconnect can be simulated by pointing
+ * it at a new pty.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <pty.h>
+#include <poll.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <common/controller_ctx.hpp>
+#include <common/sensor/chassi_status_frame.hpp>
+#include <common/sensor/chassi_status_reader.hpp>
+#include <common/sensor/sensor_ingest.hpp>
+
+using namespace hydroctrl;
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static int g_failures = 0;
+
+#define CHECK(expr)                                                            \
+    do {                                                                       \
+        if (!(expr)) {                                                         \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #expr      \
+                      << ") failed" << std::endl;                              \
+            g_failures++;                                                      \
+        }                                                                      \
+    } while (0)
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** Simulated chassi microcontroller */
+class fake_chassi
+{
+  public:
+    /** @brief Constructor
+     *
+     * @param link  Device path given to the reader, (re)pointed at the pty
+     */
+    explicit fake_chassi(std::string link) : link_(std::move(link))
+    {
+        connect();
+    }
+
+    ~fake_chassi() { hangup(); }
+
+    /** Create a new pty and point the device link at it */
+    void connect()
+    {
+        int slave = -1;
+        std::array<char, 128> name{};
+        if (openpty(&master_, &slave, name.data(), nullptr, nullptr) < 0) {
+            perror("openpty");
+            std::exit(EXIT_FAILURE);
+        }
+        ::close(slave);
+
+        unlink(link_.c_str());
+        if (symlink(name.data(), link_.c_str()) < 0) {
+            perror("symlink");
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    /** Close the master side (cable pulled) */
+    void hangup()
+    {
+        if (master_ != -1) {
+            ::close(master_);
+            master_ = -1;
+        }
+    }
+
+    void send(const std::string &data)
+    {
+        send(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+    }
+
+    void send(const uint8_t *data, std::size_t len)
+    {
+        if (write(master_, data, len) != static_cast<ssize_t>(len)) {
+            perror("write");
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+  private:
+    std::string link_;
+    int master_{-1};
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static std::string status_line(int door_alarm)
+{
+    return "temp=24.50, temp2=31.20, humidity=40.10, humidity2=38.00, "
+           "door_alarm=" +
+           std::to_string(door_alarm) +
+           ", chassi_temp_warning=1, chassi_temp_alarm=0;\r\n";
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static std::vector<uint8_t> status_frame(uint8_t flags)
+{
+    // 21.50 degC, 30.25 degC, 45.00 %RH, 50.75 %RH
+    std::vector<uint8_t> frame = {common::chassi_status_frame_sync,
+                                  common::chassi_status_frame_type,
+                                  7,
+                                  0x66, 0x08,
+                                  0xd1, 0x0b,
+                                  0x94, 0x11,
+                                  0xd3, 0x13,
+                                  flags,
+                                  0};
+    frame[12] = common::crc8(&frame[1], 11);
+    return frame;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+/** Read whatever arrives within timeout; pty input is delivered
+ *  asynchronously */
+static int read_frames(common::chassi_status_reader &reader,
+                       common::chassi_measurements &status)
+{
+    struct pollfd pfd
+    {};
+    pfd.fd = reader.get_fd();
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, 1000) <= 0) {
+        return 0;
+    }
+
+    return reader.read_input(status);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static bool system_wide_alarm(const std::shared_ptr<common::controller_ctx> &ctx)
+{
+    const std::lock_guard<std::mutex> lock(*ctx->mutex);
+    return ctx->system_wide_alarm_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static bool wait_for_alarm(const std::shared_ptr<common::controller_ctx> &ctx,
+                           bool alarm, std::chrono::seconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (system_wide_alarm(ctx) == alarm) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static void test_reader(const std::string &link)
+{
+    fake_chassi chassi(link);
+    common::chassi_status_reader reader(link);
+    CHECK(reader.open() >= 0);
+
+    common::chassi_measurements status;
+
+    // Text line split across reads
+    auto line = status_line(1);
+    chassi.send(line.substr(0, 20));
+    CHECK(read_frames(reader, status) == 0);
+    chassi.send(line.substr(20, 30));
+    CHECK(read_frames(reader, status) == 0);
+    chassi.send(line.substr(50));
+    CHECK(read_frames(reader, status) == 1);
+    CHECK(status.ambient_temp == 24.50);
+    CHECK(status.chassi_temp == 31.20);
+    CHECK(status.ambient_humidity == 40.10);
+    CHECK(status.chassi_humidity == 38.00);
+    CHECK(status.door_alarm);
+    CHECK(status.chassi_temp_warning);
+    CHECK(!status.chassi_temp_alarm);
+
+    // Binary frame split across reads
+    auto frame = status_frame(common::chassi_status_flag_temp_alarm);
+    chassi.send(frame.data(), 5);
+    CHECK(read_frames(reader, status) == 0);
+    chassi.send(frame.data() + 5, frame.size() - 5);
+    CHECK(read_frames(reader, status) == 1);
+    CHECK(status.ambient_temp == 21.50);
+    CHECK(status.chassi_temp == 30.25);
+    CHECK(status.ambient_humidity == 45.00);
+    CHECK(status.chassi_humidity == 50.75);
+    CHECK(!status.door_alarm);
+    CHECK(!status.chassi_temp_warning);
+    CHECK(status.chassi_temp_alarm);
+
+    // Corrupt frame is dropped, the reader resynchronizes on the next one
+    auto corrupt = status_frame(common::chassi_status_flag_door_alarm);
+    corrupt[12] ^= 0xff;
+    chassi.send(corrupt.data(), corrupt.size());
+    chassi.send(status_line(0));
+    CHECK(read_frames(reader, status) == 1);
+    CHECK(!status.door_alarm);
+
+    // Hangup is reported, the device can be opened again
+    chassi.hangup();
+    CHECK(read_frames(reader, status) == -1);
+    reader.close();
+
+    chassi.connect();
+    CHECK(reader.open() >= 0);
+    chassi.send(status_line(1));
+    CHECK(read_frames(reader, status) == 1);
+    CHECK(status.door_alarm);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+static void test_sensor_ingest(const std::string &link)
+{
+    fake_chassi chassi(link);
+
+    auto cfg = std::make_shared<common::configuration>();
+    cfg->sensor_ingest_port = 0;
+    cfg->chassi_serial_device = link;
+
+    auto ctx = std::make_shared<common::controller_ctx>();
+    ctx->mutex = std::make_shared<std::mutex>();
+
+    auto ingest = std::make_shared<common::sensor_ingest>(cfg, ctx);
+    std::thread([ingest] { ingest->run(); }).detach();
+
+    // Alarm raise and clear
+    chassi.send(status_line(1));
+    CHECK(wait_for_alarm(ctx, true, std::chrono::seconds(2)));
+    CHECK(ctx->chassi_status.load().chassi_temp == 31.20);
+
+    chassi.send(status_line(0));
+    CHECK(wait_for_alarm(ctx, false, std::chrono::seconds(2)));
+
+    // A chassi temperature alarm alone is system wide as well
+    auto frame = status_frame(common::chassi_status_flag_temp_alarm);
+    chassi.send(frame.data(), frame.size());
+    CHECK(wait_for_alarm(ctx, true, std::chrono::seconds(2)));
+
+    chassi.send(status_line(0));
+    CHECK(wait_for_alarm(ctx, false, std::chrono::seconds(2)));
+
+    // Reconnect after hangup. Input sent before the device is reopened is
+    // flushed, so keep sending until it gets through
+    chassi.hangup();
+    chassi.connect();
+
+    bool raised = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(15);
+    while (!raised && std::chrono::steady_clock::now() < deadline) {
+        chassi.send(status_line(1));
+        raised = wait_for_alarm(ctx, true, std::chrono::seconds(1));
+    }
+    CHECK(raised);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+int main()
+{
+    std::string link = "/tmp/chassi_status_reader_test." +
+                       std::to_string(getpid());
+
+    test_reader(link);
+    test_sensor_ingest(link);
+
+    unlink(link.c_str());
+
+    if (g_failures > 0) {
+        std::cerr << g_failures << " check(s) failed" << std::endl;
+    }
+
+    // sensor_ingest::run() does not return; skip static destruction while
+    // its thread is still running
+    std::_Exit(g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
@@ -16,8 +16,10 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <ctime>
 #include <getopt.h>
 #include <iostream>
+#include <stdexcept>
 
 #include <user_interface/console_user_interface/cli.hpp>
 
@@ -30,6 +32,14 @@ namespace user_interface {
 enum cli_option
 {
     cli_option_log_level = 1000,
+    cli_option_sensor_port,
+    cli_option_serial_device,
+    cli_option_channels,
+    cli_option_log_benchmark,
+    cli_option_simulate,
+    cli_option_simulation_start,
+    cli_option_simulation_seed,
+    cli_option_simulation_channels,
     cli_option_help
 };
 
@@ -37,6 +47,17 @@ enum cli_option
 
 static struct option long_options[] = {
     {"log-level", required_argument, nullptr, cli_option_log_level},
+    {"sensor-port", required_argument, nullptr, cli_option_sensor_port},
+    {"serial-device", required_argument, nullptr, cli_option_serial_device},
+    {"channels", required_argument, nullptr, cli_option_channels},
+    {"log-benchmark", no_argument, nullptr, cli_option_log_benchmark},
+    {"simulate", required_argument, nullptr, cli_option_simulate},
+    {"simulation-start", required_argument, nullptr,
+     cli_option_simulation_start},
+    {"simulation-seed", required_argument, nullptr,
+     cli_option_simulation_seed},
+    {"simulation-channels", required_argument, nullptr,
+     cli_option_simulation_channels},
     {"help", no_argument, nullptr, cli_option_help},
     {nullptr, 0, nullptr, 0}};
 
@@ -49,7 +70,7 @@ bool parse_command_line_arguments(std::shared_ptr<common::configuration> cfg,
     int c = 0;
     int option_index = 0;
     while (true) {
-        c = getopt_long(argc, argv, "hl:", long_options, &option_index);
+        c = getopt_long(argc, argv, "hbl:s:d:c:", long_options, &option_index);
 
         // All options parsed
         if (c == -1) {
@@ -77,6 +98,76 @@ bool parse_command_line_arguments(std::shared_ptr<common::configuration> cfg,
             }
             break;
 
+        case 's':
+        case cli_option_sensor_port:
+            cfg->sensor_ingest_port =
+                static_cast<int>(strtol(optarg, nullptr, 10));
+            if (cfg->sensor_ingest_port <= 0 ||
+                cfg->sensor_ingest_port > 65535) {
+                std::cerr << "Error: Invalid sensor port -> "
+                          << cfg->sensor_ingest_port << std::endl;
+                return false;
+            }
+            break;
+
+        case 'd':
+        case cli_option_serial_device:
+            cfg->chassi_serial_device = optarg;
+            break;
+
+        case 'c':
+        case cli_option_channels:
+            try {
+                cfg->channels = common::load_channel_definitions(optarg);
+            } catch (const std::runtime_error &ex) {
+                std::cerr << "Error: " << ex.what() << std::endl;
+                return false;
+            }
+            break;
+
+        case 'b':
+        case cli_option_log_benchmark:
+            cfg->log_benchmark = true;
+            break;
+
+        case cli_option_simulate:
+            cfg->simulation_days =
+                static_cast<int>(strtol(optarg, nullptr, 10));
+            if (cfg->simulation_days <= 0) {
+                std::cerr << "Error: Invalid number of simulated days -> "
+                          << optarg << std::endl;
+                return false;
+            }
+            break;
+
+        case cli_option_simulation_start: {
+            struct tm tstruct
+            {};
+            const char *end = strptime(optarg, "%Y-%m-%d", &tstruct);
+            if (end == nullptr || *end != '\0') {
+                std::cerr << "Error: Invalid simulation start date -> "
+                          << optarg << " (YYYY-MM-DD)" << std::endl;
+                return false;
+            }
+            cfg->simulation_start = optarg;
+            break;
+        }
+
+        case cli_option_simulation_seed:
+            cfg->simulation_seed =
+                static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+
+        case cli_option_simulation_channels:
+            cfg->simulation_channels =
+                static_cast<int>(strtol(optarg, nullptr, 10));
+            if (cfg->simulation_channels < 0) {
+                std::cerr << "Error: Invalid number of simulated channels -> "
+                          << optarg << std::endl;
+                return false;
+            }
+            break;
+
         default:
             break;
         }
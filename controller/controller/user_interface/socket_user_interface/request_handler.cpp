@@ -100,9 +100,9 @@ request_handler::create_listening_socket(int port)
             "[request_handler::create_listening_socket] listen() failed");
     }
 
-    common::log(common::log_level_debug,
-                "[request_handler::create_listening_socket] fd " +
-                    std::to_string(listening_socket->get_fd()));
+    HC_LOG(common::log_level_debug,
+           "[request_handler::create_listening_socket] fd "
+               << listening_socket->get_fd());
 
     return listening_socket;
 }
@@ -111,7 +111,7 @@ request_handler::create_listening_socket(int port)
 
 void request_handler::run()
 {
-    common::log(common::log_level_debug, "[request_handler::run]");
+    HC_LOG(common::log_level_debug, "[request_handler::run]");
 
     while (true) {
         auto events = io_monitor_->wait_for_events();
@@ -130,8 +130,8 @@ void request_handler::run()
 
                 // Socket event
                 if (event_type == common::event_type::socket) {
-                    common::log(common::log_level_debug,
-                                "[request_handler::run] socket event");
+                    HC_LOG(common::log_level_debug,
+                           "[request_handler::run] socket event");
 
                     auto socket_event =
                         std::dynamic_pointer_cast<common::socket_event>(event);
@@ -141,8 +141,8 @@ void request_handler::run()
 
                 // Timer event
                 if (event_type == common::event_type::timer) {
-                    common::log(common::log_level_debug,
-                                "[request_handler::run] timer event");
+                    HC_LOG(common::log_level_debug,
+                           "[request_handler::run] timer event");
 
                     auto timer_event =
                         std::dynamic_pointer_cast<common::timer_event>(event);
@@ -168,8 +168,8 @@ void request_handler::run()
 void request_handler::handle_client_socket_event(
     const std::shared_ptr<common::socket_event> &socket_event)
 {
-    common::log(common::log_level_debug,
-                "[request_handler::handle_client_socket_event]");
+    HC_LOG(common::log_level_debug,
+           "[request_handler::handle_client_socket_event]");
 
     auto sock = socket_event->get_socket();
     if (sock == nullptr) {
@@ -233,7 +233,7 @@ void request_handler::client_setup(const std::shared_ptr<common::socket> &sock)
     if (res == -1) {
         std::string msg =
             "[request_handler::client_setup] getsockname() failed";
-        common::log(common::log_level_debug, msg);
+        HC_LOG(common::log_level_debug, msg);
         client_teardown(sock);
         throw std::system_error(errno, std::system_category(), msg);
     }
@@ -244,17 +244,16 @@ void request_handler::client_setup(const std::shared_ptr<common::socket> &sock)
     if (res == -1) {
         std::string msg =
             "[request_handler::client_setup] getpeername() failed";
-        common::log(common::log_level_debug, msg);
+        HC_LOG(common::log_level_debug, msg);
         client_teardown(sock);
         throw std::system_error(errno, std::system_category(), msg);
     }
 
     std::string remote_ip = common::system::address_to_string(addr);
 
-    std::stringstream ss;
-    ss << "[request_handler::client_setup] "
-       << "local_ip " << local_ip << ", remote_ip " << remote_ip;
-    common::log(common::log_level_debug, ss.str());
+    HC_LOG(common::log_level_debug,
+           "[request_handler::client_setup] local_ip " << local_ip
+               << ", remote_ip " << remote_ip);
 
     msg_state state;
 
@@ -269,9 +268,8 @@ void request_handler::client_setup(const std::shared_ptr<common::socket> &sock)
 
     auto timer_id = io_monitor_->register_one_shot_timer(timeout_microsecs);
 
-    common::log(common::log_level_debug,
-                "[request_handler::client_setup] creating timer " +
-                    std::to_string(timer_id));
+    HC_LOG(common::log_level_debug,
+           "[request_handler::client_setup] creating timer " << timer_id);
 
     client_expiration data;
     data.timer_id = timer_id;
@@ -287,10 +285,8 @@ void request_handler::client_teardown(
 {
     auto sock_handle = sock->get_fd();
 
-    std::stringstream msg;
-    msg << "[request_handler::client_teardown 1] fd "
-        << std::to_string(sock_handle);
-    common::log(common::log_level_debug, msg.str());
+    HC_LOG(common::log_level_debug,
+           "[request_handler::client_teardown 1] fd " << sock_handle);
 
     if (sock->is_active()) {
         sock->close();
@@ -312,10 +308,8 @@ void request_handler::client_teardown(uint64_t timer_id)
         return;
     }
 
-    std::stringstream msg;
-    msg << "[request_handler::client_teardown 2] timer_id "
-        << std::to_string(timer_id);
-    common::log(common::log_level_debug, msg.str());
+    HC_LOG(common::log_level_debug,
+           "[request_handler::client_teardown 2] timer_id " << timer_id);
 
     auto context = client_expiration_map_[timer_id];
     auto sock_handle = context.sock->get_fd();
@@ -456,9 +450,8 @@ void request_handler::send_help_screen(
 void request_handler::handle_client_msg(
     const std::shared_ptr<common::socket> &sock, const std::string &msg)
 {
-    std::stringstream log_msg;
-    log_msg << "[request_handler::handle_client_msg] msg '" << msg << "'";
-    common::log(common::log_level::log_level_debug, log_msg.str());
+    HC_LOG(common::log_level::log_level_debug,
+           "[request_handler::handle_client_msg] msg '" << msg << "'");
 
     /** Since this device may not have an RTC or any way to run
      * NTP, set the time explicitly. The date command is steered to
@@ -468,7 +461,8 @@ void request_handler::handle_client_msg(
 
     if (msg.find("date --set") != std::string::npos) {
         std::string date_cmd = msg;
-        common::log(common::log_level::log_level_debug, "Run system cmd '" + date_cmd + "'");
+        HC_LOG(common::log_level::log_level_debug,
+               "Run system cmd '" << date_cmd << "'");
         system(date_cmd.c_str());
     }
 
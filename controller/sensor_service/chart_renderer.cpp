@@ -0,0 +1,401 @@
+#include <chart_renderer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <limits>
+
+// Same layout as the gnuplot configuration (margins are screen fractions)
+constexpr double left_margin = 0.06;
+constexpr double right_margin = 0.83;
+constexpr double top_margin = 0.96;
+constexpr double bottom_margin = 0.10;
+
+constexpr double font_size = 20;
+constexpr double title_font_size = 22;
+
+// Dots are only drawn up to this many samples, above that the line alone is clearer
+constexpr std::size_t max_marked_samples = 250;
+
+constexpr uint32_t event_rgb = 0xa25d07;
+constexpr int nr_event_markers = 7;
+
+static void set_source_rgb(cairo_t* cr, uint32_t rgb)
+{
+    cairo_set_source_rgb(cr,
+                         static_cast<double>((rgb >> 16) & 0xff) / 255.0,
+                         static_cast<double>((rgb >> 8) & 0xff) / 255.0,
+                         static_cast<double>(rgb & 0xff) / 255.0);
+}
+
+static double seconds_since_epoch(const measurement& m)
+{
+    return std::chrono::duration<double>(m.ts.time_since_epoch()).count();
+}
+
+static double value_of(const measurement& m)
+{
+    return atof(m.value.c_str());
+}
+
+/** 1, 2, 2.5 or 5 times a power of ten, giving at most max_ticks ticks */
+static double value_step(double span, int max_ticks)
+{
+    double raw = span / max_ticks;
+    double magnitude = std::pow(10, std::floor(std::log10(raw)));
+
+    for (double m : {1.0, 2.0, 2.5, 5.0}) {
+        if (m * magnitude >= raw) {
+            return m * magnitude;
+        }
+    }
+
+    return 10 * magnitude;
+}
+
+/** Calendar friendly tick distance in seconds */
+static double time_step(double span, int max_ticks)
+{
+    const double steps[] = {60, 300, 900, 1800, 3600, 2 * 3600, 3 * 3600,
+                            6 * 3600, 12 * 3600, 24 * 3600, 48 * 3600};
+
+    for (double step : steps) {
+        if (span / step <= max_ticks) {
+            return step;
+        }
+    }
+
+    return 7 * 24 * 3600;
+}
+
+chart_renderer::chart_renderer(int width, int height)
+    : width_(width), height_(height)
+{
+    surface_ = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width_, height_);
+    cr_ = cairo_create(surface_);
+}
+
+chart_renderer::~chart_renderer()
+{
+    cairo_destroy(cr_);
+    cairo_surface_destroy(surface_);
+}
+
+void chart_renderer::render(const std::string& path,
+                            const std::string& title,
+                            const std::string& y_label,
+                            const std::vector<chart_series>& series,
+                            const std::vector<chart_event_series>& events)
+{
+    plot_area area{};
+    area.x0 = width_ * left_margin;
+    area.x1 = width_ * right_margin;
+    area.y0 = height_ * (1 - top_margin);
+    area.y1 = height_ * (1 - bottom_margin);
+
+    // Autoscale
+    area.t_min = std::numeric_limits<double>::max();
+    area.t_max = std::numeric_limits<double>::lowest();
+    area.v_min = std::numeric_limits<double>::max();
+    area.v_max = std::numeric_limits<double>::lowest();
+
+    for (auto&& s : series) {
+        for (auto&& e : s.data) {
+            auto t = seconds_since_epoch(e);
+            auto v = value_of(e);
+            area.t_min = std::min(area.t_min, t);
+            area.t_max = std::max(area.t_max, t);
+            area.v_min = std::min(area.v_min, v);
+            area.v_max = std::max(area.v_max, v);
+        }
+    }
+
+    for (auto&& ev : events) {
+        for (auto&& e : ev.occurrences) {
+            auto t = seconds_since_epoch(e);
+            area.t_min = std::min(area.t_min, t);
+            area.t_max = std::max(area.t_max, t);
+        }
+    }
+
+    if (area.t_min > area.t_max) {
+        auto now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        area.t_min = now - 3600;
+        area.t_max = now;
+    } else if (area.t_max - area.t_min < 60) {
+        area.t_min -= 30;
+        area.t_max += 30;
+    }
+
+    if (area.v_min > area.v_max) {
+        area.v_min = 0;
+        area.v_max = 1;
+    } else if (area.v_max - area.v_min < 1e-6) {
+        area.v_min -= 1;
+        area.v_max += 1;
+    }
+
+    // Extend to whole ticks like gnuplot does
+    auto v_step = value_step(area.v_max - area.v_min, 10);
+    area.v_min = std::floor(area.v_min / v_step) * v_step;
+    area.v_max = std::ceil(area.v_max / v_step) * v_step;
+
+    set_source_rgb(cr_, 0xffffff);
+    cairo_paint(cr_);
+
+    cairo_select_font_face(cr_, "Helvetica", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr_, font_size);
+
+    draw_axes(area, v_step, title, y_label);
+
+    cairo_save(cr_);
+    cairo_rectangle(cr_, area.x0, area.y0, area.x1 - area.x0, area.y1 - area.y0);
+    cairo_clip(cr_);
+
+    for (auto&& ev : events) {
+        draw_events(area, ev);
+    }
+
+    for (auto&& s : series) {
+        draw_series(area, s);
+    }
+
+    cairo_restore(cr_);
+
+    draw_legend(series, events);
+
+    cairo_surface_flush(surface_);
+
+    // Readers must never see a partially written file
+    auto tmp_path = path + ".tmp";
+    auto status = cairo_surface_write_to_png(surface_, tmp_path.c_str());
+    if (status != CAIRO_STATUS_SUCCESS) {
+        std::cerr << "chart_renderer: " << cairo_status_to_string(status) << " (" << tmp_path << ")" << std::endl;
+        return;
+    }
+
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        perror("rename");
+    }
+}
+
+void chart_renderer::draw_axes(const plot_area& area, double v_step,
+                               const std::string& title, const std::string& y_label)
+{
+    cairo_text_extents_t ext;
+    const double dashes[] = {2.0, 4.0};
+
+    cairo_set_line_width(cr_, 1);
+
+    // Value grid and labels
+    for (double v = area.v_min; v <= area.v_max + v_step / 2; v += v_step) {
+        auto y = std::round(area.y(v)) + 0.5;
+
+        set_source_rgb(cr_, 0xa0a0a0);
+        cairo_set_dash(cr_, dashes, 2, 0);
+        cairo_move_to(cr_, area.x0, y);
+        cairo_line_to(cr_, area.x1, y);
+        cairo_stroke(cr_);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%g", std::fabs(v) < v_step / 1000 ? 0.0 : v);
+
+        set_source_rgb(cr_, 0x000000);
+        cairo_text_extents(cr_, label, &ext);
+        cairo_move_to(cr_, area.x0 - 10 - ext.x_advance, y + ext.height / 2);
+        cairo_show_text(cr_, label);
+    }
+
+    // Time grid and labels, aligned to local wall clock
+    auto t_step = time_step(area.t_max - area.t_min, 24);
+    time_t t_first = static_cast<time_t>(area.t_min);
+    struct tm tm_first;
+    localtime_r(&t_first, &tm_first);
+    double offset = static_cast<double>(tm_first.tm_gmtoff);
+
+    for (double t = std::ceil((area.t_min + offset) / t_step) * t_step - offset; t <= area.t_max; t += t_step) {
+        auto x = std::round(area.x(t)) + 0.5;
+
+        set_source_rgb(cr_, 0xa0a0a0);
+        cairo_set_dash(cr_, dashes, 2, 0);
+        cairo_move_to(cr_, x, area.y0);
+        cairo_line_to(cr_, x, area.y1);
+        cairo_stroke(cr_);
+
+        time_t ts = static_cast<time_t>(t);
+        struct tm tm;
+        localtime_r(&ts, &tm);
+        char label[32];
+        strftime(label, sizeof(label), "%d / %H:%M", &tm);
+
+        // Rotated labels reading bottom to top
+        set_source_rgb(cr_, 0x000000);
+        cairo_text_extents(cr_, label, &ext);
+        cairo_save(cr_);
+        cairo_move_to(cr_, x + ext.height / 2, area.y1 + 10 + ext.x_advance);
+        cairo_rotate(cr_, -M_PI / 2);
+        cairo_show_text(cr_, label);
+        cairo_restore(cr_);
+    }
+
+    cairo_set_dash(cr_, nullptr, 0, 0);
+
+    // Border
+    set_source_rgb(cr_, 0x000000);
+    cairo_rectangle(cr_, std::round(area.x0) + 0.5, std::round(area.y0) + 0.5,
+                    std::round(area.x1 - area.x0), std::round(area.y1 - area.y0));
+    cairo_stroke(cr_);
+
+    // Y label
+    cairo_text_extents(cr_, y_label.c_str(), &ext);
+    cairo_save(cr_);
+    cairo_move_to(cr_, area.x0 * 0.35, (area.y0 + area.y1) / 2 + ext.x_advance / 2);
+    cairo_rotate(cr_, -M_PI / 2);
+    cairo_show_text(cr_, y_label.c_str());
+    cairo_restore(cr_);
+
+    // Title
+    cairo_select_font_face(cr_, "Helvetica", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr_, title_font_size);
+    cairo_text_extents(cr_, title.c_str(), &ext);
+    cairo_move_to(cr_, (area.x0 + area.x1 - ext.x_advance) / 2, area.y0 - ext.height / 2);
+    cairo_show_text(cr_, title.c_str());
+    cairo_select_font_face(cr_, "Helvetica", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr_, font_size);
+}
+
+void chart_renderer::draw_series(const plot_area& area, const chart_series& series)
+{
+    if (series.data.empty()) {
+        return;
+    }
+
+    // Never more than one vertex per horizontal pixel
+    auto n = series.data.size();
+    auto line_step = std::max<std::size_t>(1, n / static_cast<std::size_t>(area.x1 - area.x0));
+
+    set_source_rgb(cr_, series.rgb);
+    cairo_set_line_width(cr_, 2);
+    cairo_set_line_join(cr_, CAIRO_LINE_JOIN_ROUND);
+
+    for (std::size_t i = 0; i < n; i += line_step) {
+        auto& e = series.data[i];
+        cairo_line_to(cr_, area.x(seconds_since_epoch(e)), area.y(value_of(e)));
+    }
+    auto& last = series.data.back();
+    cairo_line_to(cr_, area.x(seconds_since_epoch(last)), area.y(value_of(last)));
+    cairo_stroke(cr_);
+
+    auto mark_step = std::max<std::size_t>(1, n / max_marked_samples);
+    for (std::size_t i = 0; i < n; i += mark_step) {
+        auto& e = series.data[i];
+        cairo_new_sub_path(cr_);
+        cairo_arc(cr_, area.x(seconds_since_epoch(e)), area.y(value_of(e)), 3.5, 0, 2 * M_PI);
+    }
+    cairo_fill(cr_);
+}
+
+void chart_renderer::draw_events(const plot_area& area, const chart_event_series& events)
+{
+    // Same span as the gnuplot event data: 1/12 to 11/12 of the value range
+    auto range = area.v_max - area.v_min;
+    auto v_low = area.v_min + range / 12;
+    auto v_high = area.v_min + range * 11 / 12;
+
+    set_source_rgb(cr_, event_rgb);
+    cairo_set_line_width(cr_, 1);
+
+    for (auto&& e : events.occurrences) {
+        auto x = std::round(area.x(seconds_since_epoch(e))) + 0.5;
+        cairo_move_to(cr_, x, area.y(v_low));
+        cairo_line_to(cr_, x, area.y(v_high));
+        cairo_stroke(cr_);
+        draw_marker(x, area.y(v_high), events.marker % nr_event_markers);
+    }
+}
+
+void chart_renderer::draw_marker(double x, double y, int marker)
+{
+    constexpr double r = 6;
+
+    cairo_new_path(cr_);
+
+    switch (marker) {
+    case 0: // circle
+        cairo_arc(cr_, x, y, r, 0, 2 * M_PI);
+        cairo_stroke(cr_);
+        break;
+    case 1: // filled circle
+        cairo_arc(cr_, x, y, r, 0, 2 * M_PI);
+        cairo_fill(cr_);
+        break;
+    case 2: // square
+        cairo_rectangle(cr_, x - r, y - r, 2 * r, 2 * r);
+        cairo_stroke(cr_);
+        break;
+    case 3: // filled square
+        cairo_rectangle(cr_, x - r, y - r, 2 * r, 2 * r);
+        cairo_fill(cr_);
+        break;
+    case 4: // triangle
+        cairo_move_to(cr_, x, y - r);
+        cairo_line_to(cr_, x + r, y + r);
+        cairo_line_to(cr_, x - r, y + r);
+        cairo_close_path(cr_);
+        cairo_stroke(cr_);
+        break;
+    case 5: // cross
+        cairo_move_to(cr_, x - r, y - r);
+        cairo_line_to(cr_, x + r, y + r);
+        cairo_move_to(cr_, x + r, y - r);
+        cairo_line_to(cr_, x - r, y + r);
+        cairo_stroke(cr_);
+        break;
+    default: // diamond
+        cairo_move_to(cr_, x, y - r);
+        cairo_line_to(cr_, x + r, y);
+        cairo_line_to(cr_, x, y + r);
+        cairo_line_to(cr_, x - r, y);
+        cairo_close_path(cr_);
+        cairo_stroke(cr_);
+        break;
+    }
+}
+
+void chart_renderer::draw_legend(const std::vector<chart_series>& series,
+                                 const std::vector<chart_event_series>& events)
+{
+    const double x = width_ * (right_margin + 0.015);
+    const double sample_width = 40;
+    const double line_height = font_size * 1.6;
+    double y = height_ * (1 - top_margin) + line_height;
+
+    for (auto&& s : series) {
+        set_source_rgb(cr_, s.rgb);
+        cairo_set_line_width(cr_, 2);
+        cairo_move_to(cr_, x, y);
+        cairo_line_to(cr_, x + sample_width, y);
+        cairo_stroke(cr_);
+        cairo_arc(cr_, x + sample_width / 2, y, 3.5, 0, 2 * M_PI);
+        cairo_fill(cr_);
+
+        set_source_rgb(cr_, 0x000000);
+        cairo_move_to(cr_, x + sample_width + 10, y + font_size / 3);
+        cairo_show_text(cr_, s.title.c_str());
+        y += line_height;
+    }
+
+    for (auto&& ev : events) {
+        set_source_rgb(cr_, event_rgb);
+        cairo_set_line_width(cr_, 1);
+        draw_marker(x + sample_width / 2, y, ev.marker % nr_event_markers);
+
+        set_source_rgb(cr_, 0x000000);
+        cairo_move_to(cr_, x + sample_width + 10, y + font_size / 3);
+        cairo_show_text(cr_, ev.title.c_str());
+        y += line_height;
+    }
+}
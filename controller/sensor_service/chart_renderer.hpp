@@ -0,0 +1,79 @@
+#pragma once
+
+#include <measurement.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cairo.h>
+
+/** Line series, e.g. sensor readings over time */
+struct chart_series
+{
+    std::string title;
+
+    std::vector<measurement> data;
+
+    /** Line colour 0xRRGGBB */
+    uint32_t rgb{0};
+};
+
+/** Event series, drawn as a vertical marker at each occurrence */
+struct chart_event_series
+{
+    std::string title;
+
+    std::vector<measurement> occurrences;
+
+    /** Marker shape, keeps a series recognisable between charts */
+    int marker{0};
+};
+
+/** In-process PNG chart renderer on top of cairo. Same layout as the
+ *  gnuplot charts: time axis, autoscaled value axis, grid and a legend
+ *  outside the plot area. */
+class chart_renderer
+{
+    public:
+        chart_renderer(int width, int height);
+        ~chart_renderer();
+
+        chart_renderer(const chart_renderer&) = delete;
+        chart_renderer& operator=(const chart_renderer&) = delete;
+
+        /** Render chart and write it to path (atomically replaced) */
+        void render(const std::string& path,
+                    const std::string& title,
+                    const std::string& y_label,
+                    const std::vector<chart_series>& series,
+                    const std::vector<chart_event_series>& events);
+
+    private:
+        struct plot_area {
+            double x0;
+            double y0;
+            double x1;
+            double y1;
+            double t_min;
+            double t_max;
+            double v_min;
+            double v_max;
+
+            double x(double t) const { return x0 + (t - t_min) / (t_max - t_min) * (x1 - x0); }
+            double y(double v) const { return y1 - (v - v_min) / (v_max - v_min) * (y1 - y0); }
+        };
+
+        void draw_axes(const plot_area& area, double v_step, const std::string& title, const std::string& y_label);
+        void draw_series(const plot_area& area, const chart_series& series);
+        void draw_events(const plot_area& area, const chart_event_series& events);
+        void draw_legend(const std::vector<chart_series>& series, const std::vector<chart_event_series>& events);
+        void draw_marker(double x, double y, int marker);
+
+        int width_;
+        int height_;
+
+        /** Reused between renders */
+        cairo_surface_t* surface_{nullptr};
+        cairo_t* cr_{nullptr};
+};
@@ -2,21 +2,88 @@
 
 #include <gnuplot.hpp>
 
+#ifdef HC_CAIRO_CHART_RENDERER
+#include <chart_renderer.hpp>
+#endif
+
 #include <iostream>
 #include <vector>
 #include <regex>
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <algorithm>
+#include <stdexcept>
 
 #include <assert.h>
 
-data_processor::data_processor()
+// max supported duration currently is 14 days
+constexpr auto history_retention = std::chrono::days(15);
+
+// Event series shown in every chart (cairo backend): name used in the legend and marker shape
+static const std::vector<std::pair<measurement_type,std::string>> chart_event_types = {
+    {measurement_type::event_upper_led, "Upper LED Event"},
+    {measurement_type::event_lower_led, "Lower LED Event"},
+    {measurement_type::event_ventilation_fan, "Ventilation Fan Event"},
+    {measurement_type::event_wind_sim_fan, "Wind Sim Fan Event"},
+    {measurement_type::event_cooling_rod, "Cooling Rod Event"},
+    {measurement_type::event_water_circulation, "Water Circulation Event"},
+    {measurement_type::event_o2_electrolysis, "O2 Electrolysis Event"},
+};
+
+data_processor::data_processor(graph_backend backend)
 {
+    select_backend(backend);
+
     // Graph generation at next expiration
     graph_generation_ts_ = std::chrono::system_clock::now();
 }
 
+// Out of line since chart_renderer is incomplete in the header
+data_processor::~data_processor() = default;
+
+void data_processor::select_backend(graph_backend backend)
+{
+    backend_ = backend;
+    gnuplot_.reset();
+#ifdef HC_CAIRO_CHART_RENDERER
+    chart_renderer_.reset();
+#endif
+
+    switch (backend) {
+    case graph_backend::gnuplot_files:
+        gnuplot_ = std::make_unique<gnuplot>("/tmp", false);
+        break;
+    case graph_backend::gnuplot_stream:
+        gnuplot_ = std::make_unique<gnuplot>("/tmp", true);
+        break;
+    case graph_backend::cairo:
+#ifdef HC_CAIRO_CHART_RENDERER
+        chart_renderer_ = std::make_unique<chart_renderer>(1920, 1080);
+#else
+        throw std::runtime_error("cairo chart renderer not available in this build");
+#endif
+        break;
+    }
+}
+
+void data_processor::enable_history(const std::string& directory)
+{
+    try {
+        auto start = std::chrono::steady_clock::now();
+
+        log_ = std::make_unique<measurement_log>(directory);
+        auto nr_records = log_->load(measurement_map_, std::chrono::system_clock::now() - history_retention);
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Restored " << nr_records << " measurements from " << directory
+                  << " in " << elapsed.count() << " ms" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "History disabled: " << e.what() << std::endl;
+        log_.reset();
+    }
+}
+
 // Entry point: incoming raw data
 void data_processor::data_ind(const char* buffer, const int buffer_len)
 {
@@ -55,7 +122,7 @@ std::string extract_sensor_value(const std::string& sensor_readings, const std::
 
 void data_processor::add_measurement(measurement_type type, const std::string& value)
 {
-    auto type_idx = static_cast<int>(type);
+    auto type_idx = static_cast<size_t>(type);
     if (type_idx < measurement_event_index_start && value.empty()) {
         return;
     }
@@ -64,6 +131,10 @@ void data_processor::add_measurement(measurement_type type, const std::string& v
     e.ts = std::chrono::system_clock::now();
     e.value = value;
     measurement_map_[type].emplace_back(e);
+
+    if (log_) {
+        log_->append(type, e.ts, type_idx < measurement_event_index_start ? atof(value.c_str()) : 0);
+    }
 }
 
 void data_processor::data_ingestion(const std::string& sensor_readings)
@@ -188,6 +259,19 @@ void data_processor::data_ingestion(const std::string& sensor_readings)
 void data_processor::generate_temperature_graphs(const std::vector<std::chrono::hours>& durations)
 {
     for(auto&& duration : durations) {
+#ifdef HC_CAIRO_CHART_RENDERER
+        if (backend_ == graph_backend::cairo) {
+            std::stringstream title;
+            title << "Temperature readings of the last " << duration.count() << "h";
+
+            render_chart("temperature_" + std::to_string(duration.count()) + "h", title.str(), "Temperature (Celcius)",
+                         {{measurement_type::sensor_ambient_temperature, "Ambient Temperature"},
+                          {measurement_type::sensor_water_temperature, "Water Temperature"}},
+                         duration);
+            continue;
+        }
+#endif
+
         auto sensor_ambient_temperature_history = history_view(measurement_type::sensor_ambient_temperature, duration);
         auto sensor_water_temperature_history = history_view(measurement_type::sensor_water_temperature, duration);
         auto event_upper_led_history = history_view(measurement_type::event_upper_led, duration);
@@ -213,9 +297,8 @@ void data_processor::generate_temperature_graphs(const std::vector<std::chrono::
             max = max2;
         }
 
-        // Each event must have its own instantiation to avoid unwanted line plotted between
-        // two event points in the graph due to them logically being connected. Split them up
-        // with the help of stats
+        // Event occurrences are written as separate segments of one data file per event
+        // type. The stats only tell which event series have data to plot
         std::unordered_map<std::string,std::size_t> event_stats;
         event_stats["upper_led"] = event_upper_led_history.size();
         event_stats["lower_led"] = event_lower_led_history.size();
@@ -225,7 +308,7 @@ void data_processor::generate_temperature_graphs(const std::vector<std::chrono::
         event_stats["water_circulation"] = event_water_circulation_history.size();
         event_stats["o2_electrolysis"] = event_o2_electrolysis_history.size();
 
-        auto gp = gnuplot("/tmp");
+        auto& gp = *gnuplot_;
 
         std::stringstream file_name;
         std::stringstream title;
@@ -254,6 +337,18 @@ void data_processor::generate_temperature_graphs(const std::vector<std::chrono::
 void data_processor::generate_humidity_graphs(const std::vector<std::chrono::hours>& durations)
 {
     for(auto&& duration : durations) {
+#ifdef HC_CAIRO_CHART_RENDERER
+        if (backend_ == graph_backend::cairo) {
+            std::stringstream title;
+            title << "Humidity readings of the last " << duration.count() << "h";
+
+            render_chart("humidity_" + std::to_string(duration.count()) + "h", title.str(), "Humidity (percentage)",
+                         {{measurement_type::sensor_ambient_humidity, "Ambient Humidity"}},
+                         duration);
+            continue;
+        }
+#endif
+
         auto sensor_ambient_humidity_history = history_view(measurement_type::sensor_ambient_humidity, duration);
         auto event_upper_led_history = history_view(measurement_type::event_upper_led, duration);
         auto event_lower_led_history = history_view(measurement_type::event_lower_led, duration);
@@ -268,9 +363,8 @@ void data_processor::generate_humidity_graphs(const std::vector<std::chrono::hou
         auto min = history_value_min(sensor_ambient_humidity_history);
         auto max = history_value_max(sensor_ambient_humidity_history);
 
-        // Each event must have its own instantiation to avoid unwanted line plotted between
-        // two event points in the graph due to them logically being connected. Split them up
-        // with the help of stats
+        // Event occurrences are written as separate segments of one data file per event
+        // type. The stats only tell which event series have data to plot
         std::unordered_map<std::string,std::size_t> event_stats;
         event_stats["upper_led"] = event_upper_led_history.size();
         event_stats["lower_led"] = event_lower_led_history.size();
@@ -280,7 +374,7 @@ void data_processor::generate_humidity_graphs(const std::vector<std::chrono::hou
         event_stats["water_circulation"] = event_water_circulation_history.size();
         event_stats["o2_electrolysis"] = event_o2_electrolysis_history.size();
 
-        auto gp = gnuplot("/tmp");
+        auto& gp = *gnuplot_;
 
         std::stringstream file_name;
         std::stringstream title;
@@ -308,6 +402,18 @@ void data_processor::generate_humidity_graphs(const std::vector<std::chrono::hou
 void data_processor::generate_water_ec_graphs(const std::vector<std::chrono::hours>& durations)
 {
     for(auto&& duration : durations) {
+#ifdef HC_CAIRO_CHART_RENDERER
+        if (backend_ == graph_backend::cairo) {
+            std::stringstream title;
+            title << "Water EC readings of the last " << duration.count() << "h";
+
+            render_chart("water_ec_" + std::to_string(duration.count()) + "h", title.str(), "Water EC",
+                         {{measurement_type::sensor_water_ec, "Water EC"}},
+                         duration);
+            continue;
+        }
+#endif
+
         auto sensor_water_ec_history = history_view(measurement_type::sensor_water_ec, duration);
         auto event_upper_led_history = history_view(measurement_type::event_upper_led, duration);
         auto event_lower_led_history = history_view(measurement_type::event_lower_led, duration);
@@ -322,9 +428,8 @@ void data_processor::generate_water_ec_graphs(const std::vector<std::chrono::hou
         auto min = history_value_min(sensor_water_ec_history);
         auto max = history_value_max(sensor_water_ec_history);
 
-        // Each event must have its own instantiation to avoid unwanted line plotted between
-        // two event points in the graph due to them logically being connected. Split them up
-        // with the help of stats
+        // Event occurrences are written as separate segments of one data file per event
+        // type. The stats only tell which event series have data to plot
         std::unordered_map<std::string,std::size_t> event_stats;
         event_stats["upper_led"] = event_upper_led_history.size();
         event_stats["lower_led"] = event_lower_led_history.size();
@@ -334,7 +439,7 @@ void data_processor::generate_water_ec_graphs(const std::vector<std::chrono::hou
         event_stats["water_circulation"] = event_water_circulation_history.size();
         event_stats["o2_electrolysis"] = event_o2_electrolysis_history.size();
 
-        auto gp = gnuplot("/tmp");
+        auto& gp = *gnuplot_;
 
         std::stringstream file_name;
         std::stringstream title;
@@ -387,6 +492,200 @@ void data_processor::generate_graphs(std::chrono::minutes threshold)
     graph_generation_ts_ = now;
 }
 
+#ifdef HC_CAIRO_CHART_RENDERER
+void data_processor::render_chart(const std::string& file_name,
+                                  const std::string& title,
+                                  const std::string& y_label,
+                                  const std::vector<std::pair<measurement_type,std::string>>& sensors,
+                                  std::chrono::hours duration)
+{
+    // Same colours as gnuplot line styles 1 and 2
+    const uint32_t colours[] = {0x95c85e, 0x97bada};
+
+    std::vector<chart_series> series;
+    for(std::size_t i=0; i < sensors.size(); i++) {
+        chart_series s;
+        s.title = sensors[i].second;
+        s.data = history_view(sensors[i].first, duration);
+        s.rgb = colours[i % 2];
+        series.emplace_back(std::move(s));
+    }
+
+    std::vector<chart_event_series> events;
+    for(std::size_t i=0; i < chart_event_types.size(); i++) {
+        auto history = history_view(chart_event_types[i].first, duration);
+        if (history.empty()) {
+            continue;
+        }
+
+        chart_event_series ev;
+        ev.title = chart_event_types[i].second;
+        ev.occurrences = std::move(history);
+        ev.marker = static_cast<int>(i);
+        events.emplace_back(std::move(ev));
+    }
+
+    chart_renderer_->render("/tmp/" + file_name + ".png", title, y_label, series, events);
+}
+#endif // HC_CAIRO_CHART_RENDERER
+
+sensor_query_status data_processor::query(const sensor_query_request& request,
+                                          sensor_query_response& response,
+                                          std::vector<sensor_query_bucket>& buckets)
+{
+    buckets.clear();
+
+    if (request.series > static_cast<uint32_t>(measurement_type::event_o2_electrolysis)) {
+        return sensor_query_status::unknown_series;
+    }
+
+    auto type = static_cast<measurement_type>(request.series);
+    bool is_event = request.series >= measurement_event_index_start;
+
+    static const std::vector<measurement> no_history;
+    auto it = measurement_map_.find(type);
+    const auto& history = it != measurement_map_.end() ? it->second : no_history;
+
+    auto ts_ms = [](const measurement& m) -> int64_t {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(m.ts.time_since_epoch()).count();
+    };
+    auto value_of = [is_event](const measurement& m) -> float {
+        return is_event ? 0.0f : strtof(m.value.c_str(), nullptr);
+    };
+
+    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Latest sample
+    if (request.from_ms == 0 && request.to_ms == 0) {
+        response.from_ms = now_ms;
+        response.to_ms = now_ms;
+
+        if (!history.empty()) {
+            auto v = value_of(history.back());
+            response.from_ms = ts_ms(history.back());
+            buckets.push_back({ts_ms(history.back()), v, v, v, 1});
+        }
+        return sensor_query_status::ok;
+    }
+
+    auto from = request.from_ms;
+    auto to = request.to_ms != 0 ? request.to_ms : now_ms;
+    if (from >= to || request.resolution > sensor_query_max_buckets) {
+        return sensor_query_status::bad_request;
+    }
+
+    response.from_ms = from;
+    response.to_ms = to;
+
+    // History is in chronological order
+    auto lower = [](const measurement& m, std::chrono::time_point<std::chrono::system_clock> ts) { return m.ts < ts; };
+    auto first = std::lower_bound(history.begin(), history.end(),
+        std::chrono::time_point<std::chrono::system_clock>(std::chrono::milliseconds(from)), lower);
+    auto last = std::lower_bound(first, history.end(),
+        std::chrono::time_point<std::chrono::system_clock>(std::chrono::milliseconds(to)), lower);
+
+    // Raw samples, the most recent ones when they do not fit
+    if (request.resolution == 0) {
+        auto status = sensor_query_status::ok;
+        if (std::distance(first, last) > static_cast<std::ptrdiff_t>(sensor_query_max_buckets)) {
+            first = last - sensor_query_max_buckets;
+            status = sensor_query_status::truncated;
+        }
+
+        buckets.reserve(static_cast<std::size_t>(std::distance(first, last)));
+        for (auto m = first; m != last; ++m) {
+            auto v = value_of(*m);
+            buckets.push_back({ts_ms(*m), v, v, v, 1});
+        }
+        return status;
+    }
+
+    // Aggregate into equally sized buckets
+    auto nr_buckets = request.resolution;
+    auto width = static_cast<double>(to - from) / nr_buckets;
+
+    buckets.resize(nr_buckets);
+    std::vector<double> sums(nr_buckets, 0);
+    for (uint32_t i = 0; i < nr_buckets; i++) {
+        buckets[i] = {from + static_cast<int64_t>(i * width), 0, 0, 0, 0};
+    }
+
+    for (auto m = first; m != last; ++m) {
+        auto idx = std::min<std::size_t>(nr_buckets - 1, static_cast<std::size_t>((ts_ms(*m) - from) / width));
+        auto& b = buckets[idx];
+        auto v = value_of(*m);
+
+        if (b.count == 0 || v < b.min) {
+            b.min = v;
+        }
+        if (b.count == 0 || v > b.max) {
+            b.max = v;
+        }
+        sums[idx] += v;
+        b.count++;
+    }
+
+    for (uint32_t i = 0; i < nr_buckets; i++) {
+        if (buckets[i].count > 0) {
+            buckets[i].mean = static_cast<float>(sums[i] / buckets[i].count);
+        }
+    }
+
+    return sensor_query_status::ok;
+}
+
+void data_processor::benchmark(std::size_t samples_per_series)
+{
+    // Synthetic history spanning the longest graph duration
+    auto now = std::chrono::system_clock::now();
+    auto window = std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::hours(336));
+    auto interval = window / static_cast<int64_t>(samples_per_series);
+
+    measurement_map_.clear();
+    for(std::size_t i=0; i < samples_per_series; i++) {
+        auto ts = now - window + interval * static_cast<int64_t>(i);
+        auto x = static_cast<double>(i) / 500;
+
+        measurement_map_[measurement_type::sensor_ambient_temperature].push_back({ts, std::to_string(24 + 3 * std::sin(x))});
+        measurement_map_[measurement_type::sensor_water_temperature].push_back({ts, std::to_string(20 + std::cos(x))});
+        measurement_map_[measurement_type::sensor_ambient_humidity].push_back({ts, std::to_string(55 + 10 * std::sin(x / 3))});
+        measurement_map_[measurement_type::sensor_water_ec].push_back({ts, std::to_string(1.2 + 0.1 * std::cos(x / 7))});
+    }
+
+    // Hourly channel events
+    for(auto&& ev : chart_event_types) {
+        for(auto ts = now - window; ts < now; ts += std::chrono::hours(1)) {
+            measurement_map_[ev.first].push_back({ts, ""});
+        }
+    }
+
+    // The streaming backend is asynchronous and cannot be timed from here
+    std::vector<std::pair<graph_backend,std::string>> backends = {
+        {graph_backend::gnuplot_files, "gnuplot (files)"},
+#ifdef HC_CAIRO_CHART_RENDERER
+        {graph_backend::cairo, "cairo"},
+#endif
+    };
+
+    auto initial_backend = backend_;
+
+    for(auto&& backend : backends) {
+        select_backend(backend.first);
+
+        auto start = std::chrono::steady_clock::now();
+        graph_generation_ts_ = std::chrono::system_clock::now();
+        generate_graphs(std::chrono::minutes(0));
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        // 3 chart types times 8 durations
+        std::cout << backend.second << ": " << samples_per_series << " samples/series, 24 charts in "
+                  << elapsed.count() << " ms (" << elapsed.count() / 24.0 << " ms/chart)" << std::endl;
+    }
+
+    select_backend(initial_backend);
+}
+
 std::vector<measurement>
 data_processor::history_view(measurement_type type, std::chrono::hours duration)
 {
@@ -476,8 +775,7 @@ void data_processor::purge_expired_data()
 
         auto now = std::chrono::system_clock::now();
 
-        // max supported duration currently is 14 days
-        auto duration = std::chrono::days(15);
+        auto duration = history_retention;
 
         // Switch to more precise unit to avoid including too much data
         auto duration_seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
@@ -498,6 +796,9 @@ void data_processor::purge_expired_data()
         measurement_map_[type] = all_readings;
     }
 
+    if (log_) {
+        log_->purge(std::chrono::system_clock::now() - history_retention);
+    }
 }
 
 
@@ -2,19 +2,54 @@
 
 #include <string>
 
+#include <gnuplot.hpp>
 #include <measurement.hpp>
+#include <measurement_log.hpp>
+#include <sensor_query.hpp>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 
+class chart_renderer;
+
+/** Graph rendering backend */
+enum class graph_backend {
+    /** Script and data files in /tmp, gnuplot invoked per graph */
+    gnuplot_files,
+
+    /** Persistent gnuplot process fed over a pipe */
+    gnuplot_stream,
+
+    /** In-process cairo renderer (HC_CAIRO_CHART_RENDERER builds only) */
+    cairo,
+};
+
 class data_processor
 {
     public:
-        data_processor();
+        explicit data_processor(graph_backend backend);
+        ~data_processor();
+
+        /** Persist measurements in directory and restore the history
+         *  stored there by a previous run */
+        void enable_history(const std::string& directory);
 
         /** Data indication from network layer */
         void data_ind(const char* buffer, const int buffer_len);
 
+        /** Answer a history query from the in-memory store (see sensor_query.hpp) */
+        sensor_query_status query(const sensor_query_request& request,
+                                  sensor_query_response& response,
+                                  std::vector<sensor_query_bucket>& buckets);
+
+        /** Fill the history with synthetic readings covering the full window
+         *  and time a complete graph refresh with each available backend */
+        void benchmark(std::size_t samples_per_series);
+
     private:
+        void select_backend(graph_backend backend);
+
         /** Top level ingestion function */
         void data_ingestion(const std::string& sensor_readings);
         
@@ -30,6 +65,14 @@ class data_processor
         void generate_humidity_graphs(const std::vector<std::chrono::hours>& durations);
         void generate_water_ec_graphs(const std::vector<std::chrono::hours>& durations);
 
+#ifdef HC_CAIRO_CHART_RENDERER
+        /** Render one chart in-process with the cairo backend */
+        void render_chart(const std::string& file_name,
+                          const std::string& title,
+                          const std::string& y_label,
+                          const std::vector<std::pair<measurement_type,std::string>>& sensors,
+                          std::chrono::hours duration);
+#endif
 
         std::vector<measurement>
         history_view(measurement_type type, std::chrono::hours duration);
@@ -40,4 +83,17 @@ class data_processor
         std::unordered_map<measurement_type,std::vector<measurement>> measurement_map_;
 
         std::chrono::time_point<std::chrono::system_clock> graph_generation_ts_;
+
+        graph_backend backend_;
+
+        /** Durable history (optional) */
+        std::unique_ptr<measurement_log> log_;
+
+        /** Kept for the lifetime of the service so that a streaming gnuplot
+         *  process survives between refreshes */
+        std::unique_ptr<gnuplot> gnuplot_;
+
+#ifdef HC_CAIRO_CHART_RENDERER
+        std::unique_ptr<chart_renderer> chart_renderer_;
+#endif
 };
\ No newline at end of file
@@ -17,110 +17,69 @@
 #include <vector>
 #include <random>
 
+#include <stdio.h>
 
-gnuplot::gnuplot(std::string working_dir)
-    : working_dir_(working_dir)
+
+gnuplot::gnuplot(std::string working_dir, bool streaming)
+    : working_dir_(working_dir), streaming_(streaming)
 {
 
 }
 
+gnuplot::~gnuplot()
+{
+    close_pipe();
+}
+
 void gnuplot::common_config_helper(const std::string& file_name,
                                   const std::string& title,
                                   const std::string& data_suffix,
                                   const std::unordered_map<std::string,std::size_t>& event_stats,
                                   std::stringstream& cfg)
 {
-    for(auto&& stat : event_stats) {
-        auto key = stat.first;
-        auto iterations = stat.second;
-
-        std::vector<std::string> iteration_strings;
-        for(std::size_t i=0;i<iterations;i++) {
-            std::stringstream ss;
-            ss << "_" << std::setfill('0') << std::setw(3) << i;
-            iteration_strings.emplace_back(ss.str());
+    // Fixed order keeps the legend stable between refreshes. Each event series
+    // lives in a single data file where occurrences are separated by blank lines,
+    // so exactly one plot clause is needed per series regardless of event count.
+    struct event_series {
+        const char* key;
+        const char* title;
+        int line_style;
+    };
+
+    static const std::vector<event_series> series = {
+        {"upper_led", "Upper LED Event", 6},
+        {"lower_led", "Lower LED Event", 7},
+        {"ventilation_fan", "Ventilation Fan Event", 8},
+        {"wind_sim_fan", "Wind Sim Fan Event", 9},
+        {"cooling_rod", "Cooling Rod Event", 10},
+        {"water_circulation", "Water Circulation Event", 11},
+        {"o2_electrolysis", "O2 Electrolysis Event", 12},
+    };
+
+    for(auto&& s : series) {
+        auto it = event_stats.find(s.key);
+        if (it == event_stats.end() || it->second == 0) {
+            continue;
         }
 
-        std::string event_name;
-        if (key.find("upper_led") != std::string::npos) {
-            std::string title = "title 'Upper LED Event' ";
-            bool first_round = true;
-            for(auto iteration : iteration_strings) {
-                if (!first_round) {
-                    title = "notitle ";
-                }
-                cfg << "     '" << working_dir_ << "/event_upper_led_" << data_suffix << iteration << ".data' using 1:3 " << title << "with linespoints ls 6, \\" << std::endl;
-                first_round = false;
-            }
-        } else if (key.find("lower_led") != std::string::npos) {
-            std::string title = "title 'Lower LED Event' ";
-            bool first_round = true;
-            for(auto iteration : iteration_strings) {
-                if (!first_round) {
-                    title = "notitle ";
-                }
-                cfg << "     '" << working_dir_ << "/event_lower_led_" << data_suffix << iteration <<".data' using 1:3 " << title << "with linespoints ls 7, \\" << std::endl;
-                first_round = false;
-            }
-        } else if (key.find("ventilation_fan") != std::string::npos) {
-            std::string title = "title 'Ventilation Fan Event' ";
-            bool first_round = true;
-            for(auto iteration : iteration_strings) {
-                if (!first_round) {
-                    title = "notitle ";
-                }
-                cfg << "     '" << working_dir_ << "/event_ventilation_fan_" << data_suffix << iteration << ".data' using 1:3 " << title << "with linespoints ls 8, \\" << std::endl;
-                first_round = false;
-            }
-        } else if (key.find("wind_sim_fan") != std::string::npos) {
-            std::string title = "title 'Wind Sim Fan Event' ";
-            bool first_round = true;
-            for(auto iteration : iteration_strings) {
-                if (!first_round) {
-                    title = "notitle ";
-                }
-                cfg << "     '" << working_dir_ << "/event_wind_sim_fan_" << data_suffix << iteration << ".data' using 1:3 " << title << "with linespoints ls 9, \\" << std::endl;
-                first_round = false;
-            }
-        } else if (key.find("cooling_rod") != std::string::npos) {
-            std::string title = "title 'Cooling Rod Event' ";
-            bool first_round = true;
-            for(auto iteration : iteration_strings) {
-                if (!first_round) {
-                    title = "notitle ";
-                }
-                cfg << "     '" << working_dir_ << "/event_cooling_rod_" << data_suffix << iteration << ".data' using 1:3 " << title << "with linespoints ls 10, \\" << std::endl;
-                first_round = false;
-            }
-        } else if (key.find("water_circulation") != std::string::npos) {
-            std::string title = "title 'Water Circulation Event' ";
-            bool first_round = true;
-            for(auto iteration : iteration_strings) {
-                if (!first_round) {
-                    title = "notitle ";
-                }
-                cfg << "     '" << working_dir_ << "/event_water_circulation_" << data_suffix << iteration << ".data' using 1:3 " << title << "with linespoints ls 11, \\" << std::endl;
-                first_round = false;
-            }
-        } else if (key.find("o2_electrolysis") != std::string::npos) {
-            std::string title = "title 'O2 Electrolysis Event' ";
-            bool first_round = true;
-            for(auto iteration : iteration_strings) {
-                if (!first_round) {
-                    title = "notitle ";
-                }
-                cfg << "     '" << working_dir_ << "/event_o2_electrolysis_" << data_suffix << iteration << ".data' using 1:3 " << title << "with linespoints ls 12, \\" << std::endl;
-                first_round = false;
-            }
-        }
+        cfg << "     " << data_source(std::string("event_") + s.key + "_" + data_suffix) << " using 1:3 title '"
+            << s.title << "' with linespoints ls " << s.line_style << ", \\" << std::endl;
     }
 
     // Terminate conditional lines above so that ', \\' can always be specified. This simplifies everything
-    // The file does not exist and is ignored.
-    cfg << "     '" << working_dir_ << "/end_marker" << ".data' using 1:3 title '' with linespoints ls 12" << std::endl;
+    // The file (or datablock) holds no data and is ignored.
+    cfg << "     " << data_source("end_marker") << " using 1:3 title '' with linespoints ls 12" << std::endl;
 
     cfg << std::endl;
 
+    if (streaming_) {
+        // Close the PNG so that it is complete on disk once gnuplot has processed the script
+        cfg << "unset output" << std::endl;
+        write_data("end_marker", "");
+        script_ = cfg.str();
+        return;
+    }
+
     std::stringstream path;
     path << working_dir_ << "/" << file_name << ".gnuplot";
 
@@ -166,8 +125,8 @@ void gnuplot::generate_temperature_config_file(const std::string& file_name,
         << "set key outside" << std::endl
         << std::endl;
 
-     cfg << "plot '" << working_dir_ << "/sensor_ambient_temperature_" << data_suffix << ".data' using 1:3 title 'Ambient Temperature' with linespoints ls 1, \\" << std::endl
-         << "     '" << working_dir_ << "/sensor_water_temperature_" << data_suffix << ".data' using 1:3 title 'Water Temperature' with linespoints ls 2, \\" << std::endl;
+     cfg << "plot " << data_source("sensor_ambient_temperature_" + data_suffix) << " using 1:3 title 'Ambient Temperature' with linespoints ls 1, \\" << std::endl
+         << "     " << data_source("sensor_water_temperature_" + data_suffix) << " using 1:3 title 'Water Temperature' with linespoints ls 2, \\" << std::endl;
 
     common_config_helper(file_name,
                          title,
@@ -213,7 +172,7 @@ void gnuplot::generate_humidity_config_file(const std::string& file_name,
         << "set key outside" << std::endl
         << std::endl;
 
-     cfg << "plot '" << working_dir_ << "/sensor_ambient_humidity_" << data_suffix << ".data' using 1:3 title 'Ambient Humidity' with linespoints ls 1, \\" << std::endl;
+     cfg << "plot " << data_source("sensor_ambient_humidity_" + data_suffix) << " using 1:3 title 'Ambient Humidity' with linespoints ls 1, \\" << std::endl;
 
     common_config_helper(file_name,
                          title,
@@ -259,7 +218,7 @@ void gnuplot::generate_water_ec_config_file(const std::string& file_name,
         << "set key outside" << std::endl
         << std::endl;
 
-     cfg << "plot '" << working_dir_ << "/sensor_water_ec_" << data_suffix << ".data' using 1:3 title 'Water EC' with linespoints ls 1, \\" << std::endl;
+     cfg << "plot " << data_source("sensor_water_ec_" + data_suffix) << " using 1:3 title 'Water EC' with linespoints ls 1, \\" << std::endl;
 
         common_config_helper(file_name,
                          title,
@@ -275,10 +234,7 @@ bool compare_samples(const measurement &a, const measurement &b)
 
 void gnuplot::generate_data_file(const std::vector<measurement>& data, const std::string& file_name)
 {
-    std::stringstream path;
-    path << working_dir_ << "/" << file_name << ".data";
-
-    std::ofstream out(path.str());
+    std::stringstream out;
 
     // There are a lot of data samples available. Plotting them all does not look great
     // in the chart. It needs to be kept below a threshold
@@ -339,13 +295,10 @@ void gnuplot::generate_data_file(const std::vector<measurement>& data, const std
         
         std::tm tm = *std::localtime(&epoch_ts);
         
-        std::stringstream line;
-        line << std::put_time(&tm, "%F %T") << "\t" << e.value << std::endl;
-
-        out << line.str();
+        out << std::put_time(&tm, "%F %T") << "\t" << e.value << "\n";
     }
-    
-    out.close();
+
+    write_data(file_name, out.str());
 }
 
 void gnuplot::generate_event_file(const std::vector<measurement>& data,
@@ -358,37 +311,102 @@ void gnuplot::generate_event_file(const std::vector<measurement>& data,
         return;
     }
 
-    std::size_t idx = 0;
-    for(auto&& e : data) {
-        std::stringstream path;
-        path << working_dir_ << "/" << file_name << "_" << std::setfill('0') << std::setw(3) << idx << ".data";
+    std::stringstream out;
 
-        std::ofstream out(path.str());
+    auto range = fabs(overall_sensor_max - overall_sensor_min);
+    auto step = range / 12;
 
+    for(auto&& e : data) {
         auto epoch_ts = std::chrono::system_clock::to_time_t(e.ts);
-        
+
         std::tm tm = *std::localtime(&epoch_ts);
-        
-         auto range = fabs(overall_sensor_max - overall_sensor_min);
-         auto step = range / 12;
 
+        // Vertical marker line for this occurrence
         auto v = overall_sensor_min;
         for(int i=0; i < 11; i++) {
             v += step;
-        
-            std::stringstream line;
-            line << std::put_time(&tm, "%F %T") << "\t" << v << std::endl;
-            out << line.str();
+            out << std::put_time(&tm, "%F %T") << "\t" << v << "\n";
         }
-        
-        out.close();
-        
-        idx++;
+
+        // A blank line ends the segment so gnuplot does not connect
+        // this occurrence with the next one
+        out << "\n";
+    }
+
+    write_data(file_name, out.str());
+}
+
+std::string gnuplot::data_source(const std::string& name)
+{
+    if (streaming_) {
+        return "$" + name;
+    }
+
+    return "'" + working_dir_ + "/" + name + ".data'";
+}
+
+void gnuplot::write_data(const std::string& name, const std::string& content)
+{
+    if (streaming_) {
+        // Inline datablock, resolved by gnuplot when the plot command refers to $name
+        datablocks_ += "$" + name + " << EOD\n" + content + "EOD\n";
+        return;
+    }
+
+    std::stringstream path;
+    path << working_dir_ << "/" << name << ".data";
+
+    std::ofstream out(path.str());
+    out << content;
+    out.close();
+}
+
+bool gnuplot::open_pipe()
+{
+    if (pipe_ != nullptr) {
+        return true;
+    }
+
+    pipe_ = popen("/usr/bin/gnuplot", "w");
+    if (pipe_ == nullptr) {
+        perror("popen(gnuplot)");
+        return false;
+    }
+
+    return true;
+}
+
+void gnuplot::close_pipe()
+{
+    if (pipe_ != nullptr) {
+        pclose(pipe_);
+        pipe_ = nullptr;
     }
 }
 
 void gnuplot::render(const std::string& file_name)
 {
+    if (streaming_) {
+        if (!open_pipe()) {
+            return;
+        }
+
+        // Data first, the script refers to it
+        fwrite(datablocks_.data(), 1, datablocks_.size(), pipe_);
+        fwrite(script_.data(), 1, script_.size(), pipe_);
+        fflush(pipe_);
+
+        datablocks_.clear();
+        script_.clear();
+
+        // The gnuplot process has exited. It is respawned on next render
+        if (ferror(pipe_)) {
+            std::cerr << "gnuplot pipe broken, restarting at next refresh" << std::endl;
+            close_pipe();
+        }
+        return;
+    }
+
     std::stringstream cmd;
     cmd << "/usr/bin/gnuplot " << working_dir_ << "/" << file_name << ".gnuplot";
 
@@ -2,6 +2,7 @@
 
 #include <measurement.hpp>
 
+#include <cstdio>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -9,7 +10,15 @@
 class gnuplot
 {
     public:
-        explicit gnuplot(std::string working_dir);
+        /** In streaming mode a single gnuplot process is kept alive and fed
+         *  scripts with inline datablocks over a pipe. Only the PNG output
+         *  touches the file system. Otherwise script and data files are
+         *  written to working_dir and gnuplot is invoked per render. */
+        gnuplot(std::string working_dir, bool streaming);
+        ~gnuplot();
+
+        gnuplot(const gnuplot&) = delete;
+        gnuplot& operator=(const gnuplot&) = delete;
 
         void generate_temperature_config_file(const std::string& file_name,
             const std::string& title,
@@ -42,5 +51,23 @@ class gnuplot
         void render(const std::string& file_name);
 
     private:
+        /** Plot source reference: file path or datablock name */
+        std::string data_source(const std::string& name);
+
+        /** Store data as file or as pending datablock */
+        void write_data(const std::string& name, const std::string& content);
+
+        bool open_pipe();
+        void close_pipe();
+
         std::string working_dir_;
+
+        bool streaming_{false};
+
+        /** gnuplot stdin (streaming mode) */
+        FILE* pipe_{nullptr};
+
+        /** Pending script and datablocks for next render (streaming mode) */
+        std::string script_;
+        std::string datablocks_;
 };
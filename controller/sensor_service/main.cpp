@@ -9,10 +9,24 @@
 #include <unistd.h>
 
 #include <data_processor.hpp>
+#include <query_server.hpp>
+
+#include <memory>
+#include <stdexcept>
 
 static int fd_201 = -1;
 static int fd_202 = -1;
 static int fd_203 = -1;
+static int fd_relay = -1;
+
+static struct sockaddr_in relay_addr;
+
+static volatile sig_atomic_t exit_requested = 0;
+
+static void on_exit_signal(int)
+{
+    exit_requested = 1;
+}
 
 static void at_exit()
 {
@@ -30,6 +44,11 @@ static void at_exit()
         close(fd_203);
         fd_203 = -1;
     }
+
+    if (fd_relay != -1) {
+        close(fd_relay);
+        fd_relay = -1;
+    }
 }
 
 int create_socket()
@@ -67,11 +86,112 @@ void bind_socket(int fd, int port)
     }
 }
 
-int main()
+/** Forward a sensor datagram to hydroctrl. Best effort: a controller that
+ *  is not running or not keeping up must never stall graph generation */
+static void relay_sensor_data(const char* buffer, int len)
+{
+    if (fd_relay == -1 || len <= 0) {
+        return;
+    }
+
+    sendto(fd_relay, buffer, len, MSG_DONTWAIT,
+           (struct sockaddr *) &relay_addr, sizeof(relay_addr));
+}
+
+static const int default_relay_port = 204;
+
+static const char* default_history_dir = "/var/lib/hydrotopia/sensor_history";
+
+static void print_help()
+{
+    printf("Usage: hydro_sensor_service [OPTIONS]\n");
+    printf("\n");
+#ifdef HC_CAIRO_CHART_RENDERER
+    printf(" Graphs are rendered in-process with cairo unless a gnuplot option is given\n");
+    printf("\n");
+#endif
+    printf(" -g --gnuplot          Render graphs with a persistent gnuplot process\n");
+    printf(" -f --gnuplot-files    Write gnuplot scripts and data files to /tmp\n");
+    printf("                       and run gnuplot per graph (debugging)\n");
+    printf(" -d --history-dir=DIR  Measurement history directory. Default: %s\n", default_history_dir);
+    printf(" -n --no-history       Keep measurements in memory only\n");
+    printf(" -s --query-socket=PATH History query socket. Default: %s\n", sensor_query_socket_path);
+    printf(" -r --relay-port=PORT  Forward sensor readings to hydroctrl on this\n");
+    printf("                       loopback UDP port, 0 disables. Default: %d\n", default_relay_port);
+    printf(" -b --benchmark        Time a full graph refresh per backend and exit\n");
+    printf(" -h --help             This help screen\n");
+    printf("\n");
+}
+
+int main(int argc, char* argv[])
 {
+#ifdef HC_CAIRO_CHART_RENDERER
+    graph_backend backend = graph_backend::cairo;
+#else
+    graph_backend backend = graph_backend::gnuplot_stream;
+#endif
+    bool benchmark = false;
+    const char* history_dir = default_history_dir;
+    const char* query_socket = sensor_query_socket_path;
+    int relay_port = default_relay_port;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-g") == 0 || strcmp(argv[i], "--gnuplot") == 0) {
+            backend = graph_backend::gnuplot_stream;
+        } else if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--gnuplot-files") == 0) {
+            backend = graph_backend::gnuplot_files;
+        } else if ((strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--history-dir") == 0) && i + 1 < argc) {
+            history_dir = argv[++i];
+        } else if (strncmp(argv[i], "--history-dir=", 14) == 0) {
+            history_dir = argv[i] + 14;
+        } else if ((strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--query-socket") == 0) && i + 1 < argc) {
+            query_socket = argv[++i];
+        } else if (strncmp(argv[i], "--query-socket=", 15) == 0) {
+            query_socket = argv[i] + 15;
+        } else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--relay-port") == 0) && i + 1 < argc) {
+            relay_port = atoi(argv[++i]);
+        } else if (strncmp(argv[i], "--relay-port=", 13) == 0) {
+            relay_port = atoi(argv[i] + 13);
+        } else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--no-history") == 0) {
+            history_dir = nullptr;
+        } else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+        } else {
+            print_help();
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
     atexit(at_exit);
 
-    data_processor dp;
+    // A gnuplot process that exits must not take the service down with it
+    signal(SIGPIPE, SIG_IGN);
+
+    // Leave the main loop on SIGTERM/SIGINT so that buffered history is written
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_exit_signal;
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    data_processor dp(backend);
+
+    if (benchmark) {
+        // Roughly one sample per 10 s over 14 days
+        dp.benchmark(120000);
+        return 0;
+    }
+
+    if (history_dir != nullptr) {
+        dp.enable_history(history_dir);
+    }
+
+    std::unique_ptr<query_server> qs;
+    try {
+        qs = std::make_unique<query_server>(query_socket);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "History queries disabled: %s\n", e.what());
+    }
 
     fd_201 = create_socket();
     fd_202 = create_socket();
@@ -81,10 +201,22 @@ int main()
     bind_socket(fd_202, 202);
     bind_socket(fd_203, 203);
 
+    if (relay_port > 0) {
+        fd_relay = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_relay < 0) {
+            perror("socket(relay)");
+        }
+
+        memset(&relay_addr, 0, sizeof(relay_addr));
+        relay_addr.sin_family = AF_INET;
+        relay_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        relay_addr.sin_port = htons((unsigned short)relay_port);
+    }
+
     struct sockaddr_in client_addr;
     socklen_t client_len = sizeof(client_addr);
 
-    while(1) {
+    while(!exit_requested) {
         static char buffer[2048];
         memset(buffer, 0, sizeof(buffer));
 
@@ -94,18 +226,28 @@ int main()
         FD_SET(fd_202, &fds);
         FD_SET(fd_203, &fds);
 
-        int res = select(fd_203 + 1, &fds, NULL, NULL, NULL);
+        int max_fd = fd_203;
+        if (qs) {
+            FD_SET(qs->fd(), &fds);
+            if (qs->fd() > max_fd) {
+                max_fd = qs->fd();
+            }
+        }
+
+        int res = select(max_fd + 1, &fds, NULL, NULL, NULL);
 
         if (res > 0) {
             if (FD_ISSET(fd_201, &fds)) {
                 int len = recvfrom(fd_201, buffer, sizeof(buffer)-1, 0,
 		        (struct sockaddr *) &client_addr, &client_len);
+                relay_sensor_data(buffer, len);
                 dp.data_ind(buffer, sizeof(buffer));
             }
             
             if (FD_ISSET(fd_202, &fds)) {
                 int len = recvfrom(fd_202, buffer, sizeof(buffer)-1, 0,
 		        (struct sockaddr *) &client_addr, &client_len);
+                relay_sensor_data(buffer, len);
                 dp.data_ind(buffer, sizeof(buffer));
             }
 
@@ -114,6 +256,10 @@ int main()
 		        (struct sockaddr *) &client_addr, &client_len);
                 dp.data_ind(buffer, sizeof(buffer));
             }
+
+            if (qs && FD_ISSET(qs->fd(), &fds)) {
+                qs->handle_request(dp);
+            }
         }
     }
 
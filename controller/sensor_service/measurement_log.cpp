@@ -0,0 +1,409 @@
+#include <measurement_log.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char segment_magic[8] = {'H', 'Y', 'D', 'L', 'O', 'G', '0', '1'};
+static const char index_magic[8] = {'H', 'Y', 'D', 'I', 'D', 'X', '0', '1'};
+constexpr uint32_t segment_version = 1;
+
+/** One segment per UTC day. Expired history is removed a whole file at a time */
+constexpr int64_t segment_duration_ms = 24 * 3600 * 1000;
+
+/** Records are written in page sized batches or when this much time has passed */
+constexpr std::size_t write_batch_records = 4096 / sizeof(measurement_record);
+constexpr auto write_interval = std::chrono::seconds(10);
+
+/** fdatasync() period. Bounds data loss on power failure */
+constexpr auto sync_interval = std::chrono::seconds(60);
+
+static uint32_t record_checksum(const measurement_record& r)
+{
+    // FNV-1a over everything but the checksum itself
+    auto p = reinterpret_cast<const uint8_t*>(&r);
+    uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < offsetof(measurement_record, checksum); i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int64_t to_ms(std::chrono::time_point<std::chrono::system_clock> ts)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(ts.time_since_epoch()).count();
+}
+
+static bool write_all(int fd, const void* data, std::size_t len)
+{
+    auto p = static_cast<const uint8_t*>(data);
+    while (len > 0) {
+        auto res = write(fd, p, len);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += res;
+        len -= static_cast<std::size_t>(res);
+    }
+    return true;
+}
+
+measurement_log::measurement_log(std::string directory)
+    : directory_(std::move(directory))
+{
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        throw std::runtime_error("cannot create " + directory_ + ": " + ec.message());
+    }
+
+    buffer_.reserve(write_batch_records);
+}
+
+measurement_log::~measurement_log()
+{
+    flush(true);
+
+    if (fd_ != -1) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+std::string measurement_log::segment_path(int64_t start_ms) const
+{
+    return directory_ + "/segment_" + std::to_string(start_ms) + ".seg";
+}
+
+std::string measurement_log::index_path(int64_t start_ms) const
+{
+    return directory_ + "/segment_" + std::to_string(start_ms) + ".idx";
+}
+
+std::size_t measurement_log::load(std::unordered_map<measurement_type,std::vector<measurement>>& measurement_map,
+                                  std::chrono::time_point<std::chrono::system_clock> cutoff)
+{
+    auto cutoff_ms = to_ms(cutoff);
+
+    std::vector<int64_t> starts;
+    for (auto&& entry : std::filesystem::directory_iterator(directory_)) {
+        auto name = entry.path().filename().string();
+        int64_t start = 0;
+        int consumed = 0;
+        if (sscanf(name.c_str(), "segment_%" SCNd64 ".seg%n", &start, &consumed) == 1 &&
+            static_cast<std::size_t>(consumed) == name.size()) {
+            starts.push_back(start);
+        }
+    }
+    std::sort(starts.begin(), starts.end());
+
+    // Index files: drop expired segments without opening them and
+    // size the history vectors once
+    std::vector<std::pair<segment,bool>> segments;
+    uint64_t type_counts[max_types] = {};
+
+    for (auto start : starts) {
+        segment seg{};
+        seg.start_ms = start;
+
+        bool indexed = false;
+        int fd = open(index_path(start).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd != -1) {
+            indexed = read(fd, &seg.index, sizeof(seg.index)) == static_cast<ssize_t>(sizeof(seg.index)) &&
+                      memcmp(seg.index.magic, index_magic, sizeof(index_magic)) == 0;
+            close(fd);
+        }
+
+        if (indexed && seg.index.last_ts_ms < cutoff_ms) {
+            remove_segment(start);
+            continue;
+        }
+
+        if (indexed) {
+            for (std::size_t t = 0; t < max_types; t++) {
+                type_counts[t] += seg.index.type_counts[t];
+            }
+        }
+
+        segments.emplace_back(seg, indexed);
+    }
+
+    for (std::size_t t = 0; t < max_types; t++) {
+        if (type_counts[t] > 0) {
+            auto& v = measurement_map[static_cast<measurement_type>(t)];
+            v.reserve(v.size() + type_counts[t]);
+        }
+    }
+
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < segments.size(); i++) {
+        auto& [seg, indexed] = segments[i];
+
+        segment_index rebuilt{};
+        memcpy(rebuilt.magic, index_magic, sizeof(index_magic));
+        auto valid = load_segment(seg, measurement_map, cutoff_ms, rebuilt);
+        total += valid;
+
+        // Cut off a torn tail so that appending continues on a record boundary
+        auto valid_size = static_cast<off_t>(sizeof(segment_header) + valid * sizeof(measurement_record));
+        struct stat st{};
+        if (stat(segment_path(seg.start_ms).c_str(), &st) == 0 && st.st_size > valid_size && valid > 0) {
+            std::cerr << "measurement_log: truncating " << segment_path(seg.start_ms) << " after "
+                      << valid << " records" << std::endl;
+            if (truncate(segment_path(seg.start_ms).c_str(), valid_size) != 0) {
+                perror("truncate");
+            }
+        }
+
+        if (valid == 0) {
+            remove_segment(seg.start_ms);
+            continue;
+        }
+
+        bool newest = (i + 1 == segments.size());
+        if (newest && !indexed) {
+            // Segment that was active when the service stopped: continue appending
+            seg.index = rebuilt;
+            active_ = seg;
+            open_segment(seg.start_ms);
+            continue;
+        }
+
+        if (!indexed) {
+            // Interrupted rotation, write the missing index
+            seg.index = rebuilt;
+            active_ = seg;
+            seal_segment();
+            continue;
+        }
+
+        sealed_.push_back(seg);
+    }
+
+    return total;
+}
+
+std::size_t measurement_log::load_segment(const segment& seg,
+                                          std::unordered_map<measurement_type,std::vector<measurement>>& measurement_map,
+                                          int64_t cutoff_ms,
+                                          segment_index& rebuilt_index)
+{
+    auto path = segment_path(seg.start_ms);
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        perror(path.c_str());
+        return 0;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(segment_header))) {
+        close(fd);
+        return 0;
+    }
+
+    auto size = static_cast<std::size_t>(st.st_size);
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        perror("mmap");
+        return 0;
+    }
+    madvise(addr, size, MADV_SEQUENTIAL);
+
+    auto header = static_cast<const segment_header*>(addr);
+    if (memcmp(header->magic, segment_magic, sizeof(segment_magic)) != 0 ||
+        header->version != segment_version ||
+        header->record_size != sizeof(measurement_record)) {
+        std::cerr << "measurement_log: ignoring " << path << " (unknown format)" << std::endl;
+        munmap(addr, size);
+        return 0;
+    }
+
+    auto records = reinterpret_cast<const measurement_record*>(static_cast<const uint8_t*>(addr) + sizeof(segment_header));
+    auto nr_records = (size - sizeof(segment_header)) / sizeof(measurement_record);
+
+    std::size_t valid = 0;
+    char buffer[64];
+
+    for (; valid < nr_records; valid++) {
+        const auto& r = records[valid];
+        if (r.checksum != record_checksum(r) || r.type >= max_types) {
+            break;
+        }
+
+        if (rebuilt_index.record_count == 0) {
+            rebuilt_index.first_ts_ms = r.ts_ms;
+        }
+        rebuilt_index.record_count++;
+        rebuilt_index.last_ts_ms = r.ts_ms;
+        rebuilt_index.type_counts[r.type]++;
+
+        if (r.ts_ms < cutoff_ms) {
+            continue;
+        }
+
+        measurement m;
+        m.ts = std::chrono::time_point<std::chrono::system_clock>(std::chrono::milliseconds(r.ts_ms));
+
+        // Same representation as data_processor::data_ingestion()
+        if (r.type < measurement_event_index_start) {
+            auto res = std::to_chars(buffer, buffer + sizeof(buffer), r.value, std::chars_format::fixed, 8);
+            m.value.assign(buffer, res.ptr);
+        }
+
+        measurement_map[static_cast<measurement_type>(r.type)].emplace_back(std::move(m));
+    }
+
+    munmap(addr, size);
+    return valid;
+}
+
+void measurement_log::append(measurement_type type,
+                             std::chrono::time_point<std::chrono::system_clock> ts,
+                             double value)
+{
+    auto ts_ms = to_ms(ts);
+    auto start_ms = ts_ms - ts_ms % segment_duration_ms;
+
+    if (fd_ == -1 || start_ms != active_.start_ms) {
+        if (fd_ != -1) {
+            flush(true);
+            seal_segment();
+        }
+        open_segment(start_ms);
+    }
+
+    measurement_record r{};
+    r.ts_ms = ts_ms;
+    r.value = value;
+    r.type = static_cast<uint32_t>(type);
+    r.checksum = record_checksum(r);
+    buffer_.push_back(r);
+
+    auto& index = active_.index;
+    if (index.record_count == 0) {
+        index.first_ts_ms = ts_ms;
+    }
+    index.record_count++;
+    index.last_ts_ms = ts_ms;
+    index.type_counts[r.type % max_types]++;
+
+    auto now = std::chrono::steady_clock::now();
+    if (buffer_.size() >= write_batch_records || now - last_write_ >= write_interval) {
+        flush(now - last_sync_ >= sync_interval);
+    }
+}
+
+void measurement_log::flush(bool sync)
+{
+    if (fd_ == -1) {
+        buffer_.clear();
+        return;
+    }
+
+    if (!buffer_.empty()) {
+        if (!write_all(fd_, buffer_.data(), buffer_.size() * sizeof(measurement_record))) {
+            perror("measurement_log write");
+        }
+        buffer_.clear();
+    }
+    last_write_ = std::chrono::steady_clock::now();
+
+    if (sync) {
+        fdatasync(fd_);
+        last_sync_ = last_write_;
+    }
+}
+
+void measurement_log::purge(std::chrono::time_point<std::chrono::system_clock> cutoff)
+{
+    auto cutoff_ms = to_ms(cutoff);
+
+    while (!sealed_.empty() && sealed_.front().index.last_ts_ms < cutoff_ms) {
+        remove_segment(sealed_.front().start_ms);
+        sealed_.erase(sealed_.begin());
+    }
+}
+
+void measurement_log::open_segment(int64_t start_ms)
+{
+    // Clock stepped back into a sealed segment: reopen it
+    auto it = std::find_if(sealed_.begin(), sealed_.end(),
+                           [start_ms](const segment& s) { return s.start_ms == start_ms; });
+    if (it != sealed_.end()) {
+        active_ = *it;
+        sealed_.erase(it);
+        unlink(index_path(start_ms).c_str());
+    } else if (active_.start_ms != start_ms || active_.index.record_count == 0) {
+        active_ = segment{};
+        active_.start_ms = start_ms;
+        memcpy(active_.index.magic, index_magic, sizeof(index_magic));
+    }
+
+    auto path = segment_path(start_ms);
+    fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ == -1) {
+        perror(path.c_str());
+        return;
+    }
+
+    struct stat st{};
+    if (fstat(fd_, &st) == 0 && st.st_size == 0) {
+        segment_header header{};
+        memcpy(header.magic, segment_magic, sizeof(segment_magic));
+        header.version = segment_version;
+        header.record_size = sizeof(measurement_record);
+        header.start_ms = start_ms;
+        if (!write_all(fd_, &header, sizeof(header))) {
+            perror(path.c_str());
+        }
+    }
+
+    last_write_ = std::chrono::steady_clock::now();
+    last_sync_ = last_write_;
+}
+
+void measurement_log::seal_segment()
+{
+    auto path = index_path(active_.start_ms);
+    auto tmp_path = path + ".tmp";
+
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd != -1) {
+        bool ok = write_all(fd, &active_.index, sizeof(active_.index));
+        close(fd);
+        if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+            perror(path.c_str());
+        }
+    }
+
+    if (fd_ != -1) {
+        close(fd_);
+        fd_ = -1;
+    }
+
+    sealed_.push_back(active_);
+    active_ = segment{};
+}
+
+void measurement_log::remove_segment(int64_t start_ms)
+{
+    unlink(segment_path(start_ms).c_str());
+    unlink(index_path(start_ms).c_str());
+}
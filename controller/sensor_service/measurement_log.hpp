@@ -0,0 +1,110 @@
+#pragma once
+
+#include <measurement.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** On-disk measurement record. Fixed size so that a segment can be
+ *  memory-mapped and walked without parsing */
+struct measurement_record
+{
+    /** Milliseconds since epoch */
+    int64_t ts_ms;
+
+    /** Sensor reading (unused for events) */
+    double value;
+
+    /** measurement_type */
+    uint32_t type;
+
+    /** Detects a torn record at the tail after power loss */
+    uint32_t checksum;
+};
+static_assert(sizeof(measurement_record) == 24, "measurement_record must be packed");
+
+/** Durable append-only measurement history.
+ *
+ *  Records are appended to one segment file per UTC day. When a segment is
+ *  rotated a small index file is written next to it with the time span and
+ *  the record count per type, so that startup can skip expired segments and
+ *  size the in-memory history up front. Appends are batched in memory and
+ *  written at most every few seconds; fdatasync() is periodic. A crash loses
+ *  at most the unsynced tail, which is detected and truncated on startup. */
+class measurement_log
+{
+    public:
+        explicit measurement_log(std::string directory);
+        ~measurement_log();
+
+        measurement_log(const measurement_log&) = delete;
+        measurement_log& operator=(const measurement_log&) = delete;
+
+        /** Restore history newer than cutoff and remove expired segments.
+         *  Must be called once before append(). Returns number of records */
+        std::size_t load(std::unordered_map<measurement_type,std::vector<measurement>>& measurement_map,
+                         std::chrono::time_point<std::chrono::system_clock> cutoff);
+
+        void append(measurement_type type,
+                    std::chrono::time_point<std::chrono::system_clock> ts,
+                    double value);
+
+        /** Remove segments that only hold data older than cutoff */
+        void purge(std::chrono::time_point<std::chrono::system_clock> cutoff);
+
+        /** Write buffered records, optionally followed by fdatasync() */
+        void flush(bool sync);
+
+    private:
+        static constexpr std::size_t max_types = 16;
+
+        struct segment_header {
+            char magic[8];
+            uint32_t version;
+            uint32_t record_size;
+            int64_t start_ms;
+        };
+
+        struct segment_index {
+            char magic[8];
+            uint64_t record_count;
+            int64_t first_ts_ms;
+            int64_t last_ts_ms;
+            uint64_t type_counts[max_types];
+        };
+
+        struct segment {
+            int64_t start_ms;
+            segment_index index;
+        };
+
+        std::string segment_path(int64_t start_ms) const;
+        std::string index_path(int64_t start_ms) const;
+
+        /** Read segment through mmap. Returns number of valid records */
+        std::size_t load_segment(const segment& seg,
+                                 std::unordered_map<measurement_type,std::vector<measurement>>& measurement_map,
+                                 int64_t cutoff_ms,
+                                 segment_index& rebuilt_index);
+
+        void open_segment(int64_t start_ms);
+        void seal_segment();
+        void remove_segment(int64_t start_ms);
+
+        std::string directory_;
+
+        /** Sealed segments, oldest first */
+        std::vector<segment> sealed_;
+
+        /** Active segment */
+        int fd_{-1};
+        segment active_{};
+
+        std::vector<measurement_record> buffer_;
+
+        std::chrono::steady_clock::time_point last_write_;
+        std::chrono::steady_clock::time_point last_sync_;
+};
@@ -0,0 +1,103 @@
+#include <query_server.hpp>
+
+#include <data_processor.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+query_server::query_server(std::string path)
+    : path_(std::move(path))
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("query socket path too long: " + path_);
+    }
+    memcpy(addr.sun_path, path_.c_str(), path_.size() + 1);
+
+    fd_ = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        throw std::runtime_error(std::string("socket(AF_UNIX): ") + strerror(errno));
+    }
+
+    // Stale socket from a previous run
+    unlink(path_.c_str());
+
+    if (bind(fd_, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        auto err = errno;
+        close(fd_);
+        fd_ = -1;
+        throw std::runtime_error("bind(" + path_ + "): " + strerror(err));
+    }
+
+    // Controller and UI do not run as root
+    chmod(path_.c_str(), 0666);
+
+    tx_buffer_.reserve(sizeof(sensor_query_response) + sensor_query_max_buckets * sizeof(sensor_query_bucket));
+}
+
+query_server::~query_server()
+{
+    if (fd_ != -1) {
+        close(fd_);
+        unlink(path_.c_str());
+    }
+}
+
+int query_server::fd() const
+{
+    return fd_;
+}
+
+void query_server::handle_request(data_processor& dp)
+{
+    sensor_query_request request;
+    memset(&request, 0, sizeof(request));
+
+    struct sockaddr_un client_addr;
+    socklen_t client_len = sizeof(client_addr);
+
+    auto len = recvfrom(fd_, &request, sizeof(request), 0,
+                        (struct sockaddr *) &client_addr, &client_len);
+    if (len < 0) {
+        perror("recvfrom(query)");
+        return;
+    }
+
+    // Unbound client, no way to answer
+    if (client_len <= sizeof(sa_family_t)) {
+        return;
+    }
+
+    sensor_query_response response;
+    memset(&response, 0, sizeof(response));
+    response.magic = sensor_query_magic;
+    response.request_id = request.request_id;
+    buckets_.clear();
+
+    if (len != sizeof(request) || request.magic != sensor_query_magic) {
+        response.status = sensor_query_status::bad_request;
+    } else {
+        response.status = dp.query(request, response, buckets_);
+    }
+    response.nr_buckets = static_cast<uint32_t>(buckets_.size());
+
+    auto header = reinterpret_cast<const uint8_t*>(&response);
+    auto payload = reinterpret_cast<const uint8_t*>(buckets_.data());
+    tx_buffer_.assign(header, header + sizeof(response));
+    tx_buffer_.insert(tx_buffer_.end(), payload, payload + buckets_.size() * sizeof(sensor_query_bucket));
+
+    if (sendto(fd_, tx_buffer_.data(), tx_buffer_.size(), MSG_DONTWAIT,
+               (struct sockaddr *) &client_addr, client_len) < 0) {
+        perror("sendto(query)");
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <sensor_query.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class data_processor;
+
+/** UNIX datagram socket answering sensor history queries */
+class query_server
+{
+    public:
+        explicit query_server(std::string path);
+        ~query_server();
+
+        query_server(const query_server&) = delete;
+        query_server& operator=(const query_server&) = delete;
+
+        /** Socket to monitor for readability */
+        int fd() const;
+
+        /** Receive one request and send the response */
+        void handle_request(data_processor& dp);
+
+    private:
+        std::string path_;
+
+        int fd_{-1};
+
+        std::vector<sensor_query_bucket> buckets_;
+
+        std::vector<uint8_t> tx_buffer_;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+/** Sensor history query protocol.
+ *
+ *  One request datagram is answered with one response datagram on the
+ *  UNIX datagram socket of hydro_sensor_service. All fields are host byte
+ *  order (local socket only) and naturally aligned, so a response can be
+ *  used in place as a header followed by an array of buckets.
+ *
+ *  Queries:
+ *  - Aggregate: [from_ms, to_ms) split into 'resolution' equally sized
+ *    buckets, each with min/max/mean and sample count.
+ *  - Raw:       resolution 0 returns the samples themselves (count 1),
+ *    the most recent ones if they do not fit.
+ *  - Latest:    from_ms == to_ms == 0 returns the most recent sample.
+ *
+ *  The client socket must be bound (an autobind with an address length of
+ *  sizeof(sa_family_t) is enough) for the response to be delivered.
+ *
+ *  to_ms 0 means "now". Event series (measurement_type::event_*) have no
+ *  value; their buckets carry the number of occurrences only. */
+
+#include <cstdint>
+
+constexpr uint32_t sensor_query_magic = 0x31515348; // "HSQ1"
+
+/** Default socket path */
+constexpr const char* sensor_query_socket_path = "/run/hydro_sensor_service.sock";
+
+/** Keeps a response below the default UNIX datagram size limit */
+constexpr uint32_t sensor_query_max_buckets = 4096;
+
+enum class sensor_query_status : uint32_t {
+    ok = 0,
+    bad_request = 1,
+    unknown_series = 2,
+    truncated = 3,
+};
+
+struct sensor_query_request
+{
+    uint32_t magic;
+
+    /** Echoed in the response */
+    uint32_t request_id;
+
+    /** measurement_type */
+    uint32_t series;
+
+    /** Number of buckets, 0 for raw samples */
+    uint32_t resolution;
+
+    /** Milliseconds since epoch, inclusive */
+    int64_t from_ms;
+
+    /** Milliseconds since epoch, exclusive. 0 is now */
+    int64_t to_ms;
+};
+static_assert(sizeof(sensor_query_request) == 32, "wire format");
+
+struct sensor_query_bucket
+{
+    /** Bucket start (aggregate) or sample time (raw) */
+    int64_t ts_ms;
+
+    float min;
+    float max;
+    float mean;
+
+    /** Number of samples in bucket */
+    uint32_t count;
+};
+static_assert(sizeof(sensor_query_bucket) == 24, "wire format");
+
+struct sensor_query_response
+{
+    uint32_t magic;
+    uint32_t request_id;
+    sensor_query_status status;
+    uint32_t nr_buckets;
+
+    /** Resolved query range */
+    int64_t from_ms;
+    int64_t to_ms;
+
+    // Followed by nr_buckets sensor_query_bucket entries
+};
+static_assert(sizeof(sensor_query_response) == 32, "wire format");
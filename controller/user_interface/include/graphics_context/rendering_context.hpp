@@ -80,14 +80,40 @@ class rendering_context
         void font_size(double size);
         void show_text(std::string text);
 
+        // Draw text pre-rendered by surface_cache::get_text_surface() at the
+        // current point
+        void show_text(std::shared_ptr<surface> text);
 
+        // Current font, size and source colour
+        text_style current_text_style();
 
-        void draw_surface(std::shared_ptr<surface> surface, double x, double y, double alpha);
+
+        void blit(std::shared_ptr<surface> surface, double x, double y, double alpha);
+
+        // Pixels composited by blit/fill/paint since construction
+        uint64_t composited_pixels() { return composited_pixels_; }
+
+        // Mark area (reference coordinates) to be presented with the next frame
+        void damage(double x, double y, double width, double height);
+
+        void damage_all();
+
+        // Copy damaged areas of the back buffer to the screen
+        void present();
 
     private:
+        void damage_device(double x1, double y1, double x2, double y2);
+
         std::shared_ptr<screen> screen_;
         double ref_width_;
         double ref_height_;
         anti_aliasing anti_aliasing_;
         double scale_multiplier_;
+
+        // Damaged area of the current frame (device coordinates)
+        std::shared_ptr<cairo_region_t> damage_;
+
+        uint64_t composited_pixels_{0};
+
+        text_style text_style_{};
 };
\ No newline at end of file
@@ -20,11 +20,50 @@
 #pragma once
 
 #include <string>
+#include <memory>
 #include <cairo.h>
 #include <librsvg/rsvg.h>
 
 #include <common.hpp>
 
+// Opaque backdrop and translucent overlay used to pre-composite the
+// highlight level of an asset
+struct highlight_style
+{
+    // Size of the composited surface (device pixels), 0 is the asset size.
+    // The asset is clipped to it
+    double width;
+    double height;
+
+    double bg_r;
+    double bg_g;
+    double bg_b;
+
+    double overlay_r;
+    double overlay_g;
+    double overlay_b;
+    double overlay_alpha;
+
+    // Overlay covers the top left area (device pixels)
+    double overlay_width;
+    double overlay_height;
+};
+
+// Font and colour of a pre-rendered text string
+struct text_style
+{
+    std::string face;
+    cairo_font_slant_t slant;
+    cairo_font_weight_t weight;
+
+    // Device pixels
+    double size;
+
+    double r;
+    double g;
+    double b;
+};
+
 class surface
 {
     public:
@@ -42,9 +81,28 @@ class surface
 
         void load_from_png(std::string path);
 
+        // Map raw pixels written by write_raw(). The file is mapped copy on
+        // write and used in place as surface data. Returns false if the file
+        // is missing or not valid for this host
+        bool load_from_raw(std::string path);
+
+        // Store pixels as is (native byte order, premultiplied alpha)
+        void write_raw(std::string path);
+
+        // DPI load_from_svg() renders a surface of the given width at
+        static double svg_dpi(double width);
+
+        // Opaque copy of asset on the style backdrop with the overlay applied
+        void load_highlight(std::shared_ptr<surface> asset, const highlight_style& style);
+
+        // Transparent surface just large enough for the inked area of text
+        void load_text(std::string text, const text_style& style);
+
         void write_png(std::string path);
 
-        void draw_surface(std::shared_ptr<surface> surface, double x, double y, double alpha);
+        // Composite src once with its top left corner at (x, y), clipped to
+        // the destination rectangle. Returns number of composited pixels
+        uint64_t blit(std::shared_ptr<surface> src, double x, double y, double alpha);
 
         void fill(double r, double g, double b);
 
@@ -56,6 +114,14 @@ class surface
 
         double height() { return height_; }
 
+        // Size of the pixel data
+        size_t byte_size();
+
+        // Top left corner relative to the text origin (load_text)
+        double origin_x() { return origin_x_; }
+
+        double origin_y() { return origin_y_; }
+
         void destroy();
 
     private:
@@ -67,6 +133,11 @@ class surface
 
         cairo_t* cr_{nullptr};
 
+        // Backing store of surface_ after load_from_raw()
+        void* mapping_{nullptr};
+
+        size_t mapping_size_{0};
+
         RsvgHandle* rsvg_;
 
         RsvgDimensionData dim_;
@@ -74,4 +145,8 @@ class surface
         double center_x_;
 
         double center_y_;
+
+        double origin_x_{0};
+
+        double origin_y_{0};
 };
\ No newline at end of file
@@ -19,8 +19,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
 
 #include "surface.hpp"
 
@@ -29,40 +37,128 @@ using surface_key = std::string; // path + '_' + width + '_' + height
 struct cache_entry
 {
     std::shared_ptr<surface> cached_surface;
-    int64_t last_accessed;
+    size_t bytes;
+    std::list<surface_key>::iterator lru_position;
+};
+
+struct surface_cache_stats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t entries;
+    size_t bytes;
+};
+
+// Asset to rasterise ahead of use. Size in device pixels, 0 for PNG
+struct cache_asset
+{
+    std::string path;
+    double width;
+    double height;
 };
 
 class surface_cache
 {
     public:
-        surface_cache(int screen_width, int screen_height);
+        // Surfaces are evicted least recently used first once the cached
+        // pixel data exceeds memory_budget bytes (0 is unbounded)
+        surface_cache(int screen_width, int screen_height, size_t memory_budget = default_memory_budget);
+
+        static constexpr size_t default_memory_budget = 256 * 1024 * 1024;
+
+        ~surface_cache();
+
+        surface_cache(const surface_cache&) = delete;
+        surface_cache& operator=(const surface_cache&) = delete;
+
+        // Load assets on one worker thread per core. A get_*_surface() call
+        // for an asset that is in progress waits for it instead of loading it
+        // a second time
+        void warm_up(std::vector<cache_asset> assets);
+
+        size_t warm_up_total() { return warm_up_assets_.size(); }
+
+        size_t warm_up_done() { return warm_up_done_; }
 
         std::shared_ptr<surface> get_svg_surface(std::string path, double width, double height);
         
         std::shared_ptr<surface> get_png_surface(std::string path);
 
+        // Asset pre-composited for one highlight level, so that drawing it
+        // is a single opaque blit. Cached per asset, size and style
+        std::shared_ptr<surface> get_svg_highlight_surface(std::string path, double width, double height, const highlight_style& style);
+
+        std::shared_ptr<surface> get_png_highlight_surface(std::string path, const highlight_style& style);
+
+        // Rendered text, drawn with rendering_context::show_text()
+        std::shared_ptr<surface> get_text_surface(std::string text, const text_style& style);
+
+        surface_cache_stats stats();
+
     private:
         surface_key create_key(std::string path, double width, double height);
 
-        void purge_outdated_entries();
+        // Cached surface, or nullptr after the key has been reserved for the
+        // caller to create it. Must be followed by release()
+        std::shared_ptr<surface> lookup_or_reserve(const surface_key& key);
 
-        bool path_exists(const std::string& path);
+        // Store s (if any) and wake up threads waiting for key
+        void release(const surface_key& key, std::shared_ptr<surface> s);
 
-        std::string
-        utils_basename(std::string path);
+        void warm_up_worker();
+
+        std::shared_ptr<surface> get_highlight_surface(surface_key asset_key, std::shared_ptr<surface> asset, const highlight_style& style);
+
+        // Drop least recently used surfaces until the budget is met. Surfaces
+        // still referenced outside the cache are kept, evicting them would
+        // not free anything. Called with mutex_ held
+        void evict();
+
+        bool path_exists(const std::string& path);
 
         std::string get_home_path();
 
         std::string get_dino_root();
 
+        // Content hash, size and DPI of an SVG rendering. Empty if the SVG
+        // cannot be read
         std::string get_cache_filename(std::string path, double width, double height);
 
-        void update_persistent_png_cache(std::string path, double width, double height, std::shared_ptr<surface> surface);
+        void update_persistent_cache(std::string cache_filename, std::shared_ptr<surface> surface);
 
-        std::shared_ptr<surface> load_from_persistent_cache(std::string path, double width, double height);
+        std::shared_ptr<surface> load_from_persistent_cache(std::string cache_filename);
 
         std::map<surface_key,cache_entry> cache_;
 
+        // Most recently used first
+        std::list<surface_key> lru_;
+
+        size_t memory_budget_;
+
+        size_t bytes_{0};
+
+        uint64_t hits_{0};
+
+        uint64_t misses_{0};
+
+        uint64_t evictions_{0};
+
+        // Protects everything above and in_progress_
+        std::mutex mutex_;
+
+        std::condition_variable released_;
+
+        std::set<surface_key> in_progress_;
+
+        std::vector<cache_asset> warm_up_assets_;
+
+        std::atomic<size_t> warm_up_next_{0};
+
+        std::atomic<size_t> warm_up_done_{0};
+
+        std::vector<std::thread> workers_;
+
         int screen_width_;
 
         int screen_height_;
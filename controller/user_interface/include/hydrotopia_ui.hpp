@@ -19,7 +19,9 @@
 
 #pragma once
 
+#include <ctime>
 #include <memory>
+#include <string>
 
 #include <user_interface/xlib_screen.hpp>
 #include <user_interface/ui_event.hpp>
@@ -32,18 +34,20 @@ using scene_idx = size_t;
 class hydrotopia_ui
 {
     public:
-        hydrotopia_ui(int screen_width, int screen_height, bool fullscreen);
+        hydrotopia_ui(int screen_width, int screen_height, bool fullscreen, size_t cache_budget);
 
         void run();
 
     private:
-        double target_fps_;
-        double current_fps_;
         bool exit_{false};
         bool osd_{false};
+        time_t osd_second_{0};
+        std::string osd_text_;
+        std::shared_ptr<surface> osd_surface_;
         int screen_width_;
         int screen_height_;
         bool fullscreen_;
+        size_t cache_budget_;
 
         int64_t start_ts_;
 
@@ -58,7 +62,10 @@ class hydrotopia_ui
         void draw_scene(ui_event ev);
         void draw_on_screen_display();
         void clear_on_screen_display();
+        void invalidate_on_screen_display();
+        int64_t next_deadline();
         bool initial_expose_event_{false};
+        bool scenes_initialized_{false};
         std::string elapsed_time_str(int64_t elapsed_time);
 
         void scene_init();
@@ -85,11 +85,19 @@ class navigate_object : public object
 
         void set_highlight_off(double value);
         void set_highlight_on(double value);
+
+        // Asset for a navigation state, empty if there is none
+        static std::string svg_path(navigation_state nav_state);
+
     private:
         void internal_draw();
 
         void load_svg();
 
+        std::shared_ptr<surface> highlight_surface(double alpha);
+
+        std::string svg_path_;
+
         bool hover_{false};
         bool selected_{false};
         navigation_state nav_state_;
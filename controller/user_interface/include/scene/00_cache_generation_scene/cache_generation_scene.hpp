@@ -26,13 +26,26 @@
 #include <object/object.hpp>
 #include <graphics_context/rendering_context.hpp>
 #include <graphics_context/surface_cache.hpp>
+#include <object/text_object.hpp>
 
 class cache_generation_scene : public scene
 {
     public:
         cache_generation_scene(std::shared_ptr<rendering_context> ctx, std::shared_ptr<surface_cache> sur_cache);
 
+        void begin() final;
+
         void draw() final;
         void draw(ui_event ev) final;
+
+        // Redraw progress while assets are loading
+        int64_t deadline() final;
+
+    private:
+        // Assets used by the scenes created in hydrotopia_ui::scene_init()
+        std::vector<cache_asset> startup_assets();
+
+        std::shared_ptr<text_object> progress_;
+        bool started_{false};
 };
 
@@ -39,6 +39,7 @@ class keypad_scene : public scene
         void draw() final;
         void draw(ui_event ev) final;
         void begin() final;
+        int64_t deadline() final;
 
     private:
         int64_t started_ts_{0};
@@ -40,6 +40,7 @@ class settings_scene : public scene
         void draw() final;
         void draw(ui_event ev) final;
         void begin() final;
+        int64_t deadline() final;
 
     private:
         void retrieve_channel_state();
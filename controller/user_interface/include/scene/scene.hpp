@@ -47,6 +47,10 @@ class scene
 
         virtual void begin() {};
 
+        // Time (get_ts) at which the scene needs to be drawn again without
+        // any user input, 0 if never
+        virtual int64_t deadline() { return 0; }
+
         void end() { ended_ = true; }
 
         bool ended() { return ended_; }
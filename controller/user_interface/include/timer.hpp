@@ -22,7 +22,6 @@
 #include <stdint.h>
 #include <vector>
 #include <unordered_map>
-#include <memory>
 #include <chrono>
 #include <sys/epoll.h>
 
@@ -31,8 +30,9 @@ constexpr int epoll_max_events = 200;
 class timer_event
 {
   public:
-    timer_event(uint64_t id)
+    timer_event(uint64_t id, uint64_t expirations)
      : id_(id)
+     , expirations_(expirations)
      {}
 
     uint64_t id()
@@ -40,31 +40,55 @@ class timer_event
         return id_;
     }
 
+    // Number of timer periods elapsed since the previous event, more than
+    // one means that expiries were missed. Always 1 for registered fds
+    uint64_t expirations()
+    {
+        return expirations_;
+    }
+
   private:
     uint64_t id_;
+    uint64_t expirations_;
 };
 
 class timer
 {
   public:
     timer();
+    ~timer();
+
+    timer(const timer&) = delete;
+    timer& operator=(const timer&) = delete;
 
-    uint64_t register_one_shot_timer(std::chrono::milliseconds duration);
+    // Persistent timer, initially disarmed. The timerfd is reused for every
+    // arm() and is only closed with the timer object
+    uint64_t register_timer();
 
-    std::vector<std::shared_ptr<timer_event>> wait_for_events();
+    // Expire after initial and then every period (0 for a single expiry).
+    // Re-arming replaces the previous setting
+    void arm(uint64_t id, std::chrono::microseconds initial, std::chrono::microseconds period);
+
+    void disarm(uint64_t id);
+
+    // Report readability of fd as an event. The fd is neither read nor closed
+    uint64_t register_fd(int fd);
+
+    // Block until at least one timer expires or a registered fd is readable.
+    // The returned events are valid until the next call
+    const std::vector<timer_event>& wait_for_events();
 
   private:
     void epoll_setup();
     void epoll_add(int fd);
     void epoll_teardown();
-    void timerfd_set_timer();
-    void timerfd_teardown();
 
-    std::shared_ptr<timer_event> timerfd_handle_event(int fd);
+    int timer_fd(uint64_t id);
 
-    int epoll_fd_;
+    int epoll_fd_{-1};
     struct epoll_event epoll_events_[epoll_max_events];
+    std::vector<timer_event> events_;
     std::unordered_map<int, uint64_t> timer_map_; // key: timer fd --> value: timer id
+    std::unordered_map<int, uint64_t> fd_map_; // key: external fd --> value: id
     uint64_t timer_id_{0};
 };
-
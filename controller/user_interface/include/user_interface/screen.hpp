@@ -34,6 +34,9 @@ class screen
 
         int height() { return height_; }
 
+        // Make the damaged region of the root surface visible
+        virtual void present(cairo_region_t* damage) {}
+
     protected:
         int width_;
         int height_;
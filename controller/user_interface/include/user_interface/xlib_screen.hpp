@@ -26,6 +26,7 @@
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
 #include <X11/X.h>
+#include <X11/extensions/XShm.h>
 #include <cairo.h>
 #include <cairo-xlib.h>
 
@@ -44,11 +45,30 @@ class xlib_screen : public screen
 
         std::vector<std::shared_ptr<ui_event>> poll_events();
 
+        // X connection, readable when events arrive
+        int connection_fd();
+
+        bool events_pending();
+
         void button_event(button flag, bool pressed);
 
+        void present(cairo_region_t* damage) override;
+
         void close();
 
     private:
+        bool init_shm_back_buffer();
+
+        bool init_back_buffer();
+
+        void init_window_surface();
+
+        bool back_buffer_compatible();
+
+        void set_back_buffer_byte_order();
+
+        void destroy_back_buffer_image();
+
         int xpos_;
 
         int ypos_;
@@ -65,6 +85,16 @@ class xlib_screen : public screen
 
         Atom wm_delete_{0};
 
+        GC gc_{nullptr};
+
+        // Wraps the back buffer pixels. Not used when drawing directly on the window
+        XImage* back_buffer_image_{nullptr};
+
+        // Back buffer shared with the X server (MIT-SHM)
+        bool shm_{false};
+
+        XShmSegmentInfo shm_info_{};
+
         bool closed_{false};
 
         button button_state_{button::none};
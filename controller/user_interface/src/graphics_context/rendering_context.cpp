@@ -17,8 +17,14 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include <graphics_context/rendering_context.hpp>
 
+// Anti-aliasing may touch pixels just outside of the path extents
+constexpr double damage_margin = 2;
+
 rendering_context::rendering_context(std::shared_ptr<screen> screen,
                   double ref_width,
                   double ref_height,
@@ -27,6 +33,7 @@ rendering_context::rendering_context(std::shared_ptr<screen> screen,
     , ref_width_(ref_width)
     , ref_height_(ref_height)
     , anti_aliasing_(anti_aliasing)
+    , damage_(cairo_region_create(), cairo_region_destroy)
 {
     // Calculate scale multiplier
     // Assumption: using the same aspect ratio
@@ -71,24 +78,74 @@ double rendering_context::iscale(double value)
     return value / scale_multiplier_;
 }
 
-void rendering_context::draw_surface(std::shared_ptr<surface> surface, double x, double y, double alpha)
+void rendering_context::damage(double x, double y, double width, double height)
 {
-    auto cr = screen_->root_surface()->cr();
-    cairo_set_source_surface (cr, surface->handle(), scale(x), scale(y));
-    cairo_paint_with_alpha (cr, alpha);
-    cairo_paint(cr);
+    damage_device(scale(x), scale(y), scale(x + width), scale(y + height));
+}
+
+void rendering_context::damage_all()
+{
+    damage_device(0, 0, screen_->width(), screen_->height());
+}
+
+void rendering_context::damage_device(double x1, double y1, double x2, double y2)
+{
+    cairo_rectangle_int_t rect;
+    rect.x = static_cast<int>(std::floor(std::max(x1 - damage_margin, 0.0)));
+    rect.y = static_cast<int>(std::floor(std::max(y1 - damage_margin, 0.0)));
+    rect.width = static_cast<int>(std::ceil(std::min(x2 + damage_margin, static_cast<double>(screen_->width())))) - rect.x;
+    rect.height = static_cast<int>(std::ceil(std::min(y2 + damage_margin, static_cast<double>(screen_->height())))) - rect.y;
+
+    if (rect.width <= 0 || rect.height <= 0) {
+        return;
+    }
+
+    cairo_region_union_rectangle(damage_.get(), &rect);
+}
+
+void rendering_context::present()
+{
+    if (cairo_region_is_empty(damage_.get())) {
+        return;
+    }
+
+    screen_->present(damage_.get());
+
+    damage_ = std::shared_ptr<cairo_region_t>(cairo_region_create(), cairo_region_destroy);
+}
+
+void rendering_context::blit(std::shared_ptr<surface> surface, double x, double y, double alpha)
+{
+    if (surface == nullptr || surface->handle() == nullptr) {
+        return;
+    }
+
+    damage_device(scale(x),
+                  scale(y),
+                  scale(x) + cairo_image_surface_get_width(surface->handle()),
+                  scale(y) + cairo_image_surface_get_height(surface->handle()));
+
+    composited_pixels_ += screen_->root_surface()->blit(surface, scale(x), scale(y), alpha);
 }
 
 void rendering_context::set_source_rgb(double r, double g, double b)
 {
     auto cr = screen_->root_surface()->cr();
     cairo_set_source_rgb(cr, r, g, b);
+
+    text_style_.r = r;
+    text_style_.g = g;
+    text_style_.b = b;
 }
 
 void rendering_context::set_source_rgba(double r, double g, double b, double a)
 {
     auto cr = screen_->root_surface()->cr();
     cairo_set_source_rgba(cr, r, g, b, a);
+
+    text_style_.r = r;
+    text_style_.g = g;
+    text_style_.b = b;
 }
 
 void rendering_context::line_width(double width)
@@ -130,18 +187,29 @@ void rendering_context::rectangle(double x, double y, double width, double heigh
 void rendering_context::fill()
 {
     auto cr = screen_->root_surface()->cr();
+    double x1, y1, x2, y2;
+    cairo_fill_extents(cr, &x1, &y1, &x2, &y2);
+    damage_device(x1, y1, x2, y2);
+    composited_pixels_ += static_cast<uint64_t>((x2 - x1) * (y2 - y1));
     cairo_fill(cr);
 }
 
 void rendering_context::stroke()
 {
     auto cr = screen_->root_surface()->cr();
+    double x1, y1, x2, y2;
+    cairo_stroke_extents(cr, &x1, &y1, &x2, &y2);
+    damage_device(x1, y1, x2, y2);
     cairo_stroke(cr);
 }
 
 void rendering_context::paint()
 {
     auto cr = screen_->root_surface()->cr();
+    double x1, y1, x2, y2;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+    damage_device(x1, y1, x2, y2);
+    composited_pixels_ += static_cast<uint64_t>((x2 - x1) * (y2 - y1));
     cairo_paint(cr);
 }
 
@@ -174,20 +242,56 @@ void rendering_context::font_face(std::string name, font_slant slant, font_weigh
     
     auto cr = screen_->root_surface()->cr();
     cairo_select_font_face(cr, name.c_str(), cr_slant, cr_weight);
+
+    text_style_.face = name;
+    text_style_.slant = cr_slant;
+    text_style_.weight = cr_weight;
 }
 
 void rendering_context::font_size(double size)
 {
     auto cr = screen_->root_surface()->cr();
     cairo_set_font_size(cr, scale(size));
+
+    text_style_.size = scale(size);
+}
+
+text_style rendering_context::current_text_style()
+{
+    return text_style_;
 }
 
 void rendering_context::show_text(std::string text)
 {
     auto cr = screen_->root_surface()->cr();
+    double x, y;
+    cairo_text_extents_t extents;
+    cairo_get_current_point(cr, &x, &y);
+    cairo_text_extents(cr, text.c_str(), &extents);
+    damage_device(x + extents.x_bearing,
+                  y + extents.y_bearing,
+                  x + extents.x_bearing + extents.width,
+                  y + extents.y_bearing + extents.height);
     cairo_show_text(cr, text.c_str());
 }
 
+void rendering_context::show_text(std::shared_ptr<surface> text)
+{
+    if (text == nullptr || text->handle() == nullptr) {
+        return;
+    }
+
+    // Glyphs were rendered at a whole pixel origin
+    auto cr = screen_->root_surface()->cr();
+    double x, y;
+    cairo_get_current_point(cr, &x, &y);
+    x = std::round(x) + text->origin_x();
+    y = std::round(y) + text->origin_y();
+
+    damage_device(x, y, x + text->width(), y + text->height());
+    composited_pixels_ += screen_->root_surface()->blit(text, x, y, 1);
+}
+
 void rendering_context::set_dash(const double* dashes,
                       int num_dashes,
                       double offset)
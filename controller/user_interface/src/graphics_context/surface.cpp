@@ -17,11 +17,36 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <graphics_context/surface.hpp>
 
+// Raw pixel file: header followed by height * stride bytes of pixel data
+struct raw_header
+{
+    char magic[8];
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+};
+
+static constexpr char raw_magic[8] = {'H', 'U', 'I', 'R', 'A', 'W', '1', '\0'};
+
+// Keeps pixel rows 64 byte aligned in the mapping
+static constexpr size_t raw_data_offset = 64;
+
 surface::surface()
 {
 }
@@ -56,6 +81,12 @@ void surface::destroy()
         cairo_surface_destroy(surface_);
         surface_ = nullptr;
     }
+
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+    }
 }
 
 void surface::load_background(double r, double g, double b)
@@ -97,17 +128,7 @@ void surface::load_from_svg(std::string path)
         return;
     }
 
-    // Set high DPI to accomodate any screen resolution up to 8k
-    // Scale it with respect to the actually needed resolution since
-    // this has a very significant effect on performance.
-    double prop = width_ / static_cast<double>(ref_width);
-    double dpi = 660 * prop;
-    if (dpi < 1) {
-        dpi = 1;
-    }
-    if (dpi > 660) {
-        dpi = 660;
-    }
+    double dpi = svg_dpi(width_);
     printf("Loading %s (DPI %.3f)\n", path.c_str(), dpi);
 
     rsvg_handle_set_dpi(rsvg_, dpi);
@@ -140,6 +161,23 @@ void surface::load_from_svg(std::string path)
     g_object_unref(rsvg_);
 }
 
+double surface::svg_dpi(double width)
+{
+    // Set high DPI to accomodate any screen resolution up to 8k
+    // Scale it with respect to the actually needed resolution since
+    // this has a very significant effect on performance.
+    double prop = width / static_cast<double>(ref_width);
+    double dpi = 660 * prop;
+    if (dpi < 1) {
+        dpi = 1;
+    }
+    if (dpi > 660) {
+        dpi = 660;
+    }
+
+    return dpi;
+}
+
 void surface::load_from_png(std::string path)
 {
     surface_ = cairo_image_surface_create_from_png(path.c_str());
@@ -151,6 +189,174 @@ void surface::load_from_png(std::string path)
     }
 }
 
+bool surface::load_from_raw(std::string path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < raw_data_offset) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    raw_header header;
+    memcpy(&header, mapping, sizeof(header));
+
+    auto format = static_cast<cairo_format_t>(header.format);
+    bool valid = memcmp(header.magic, raw_magic, sizeof(raw_magic)) == 0 &&
+                 (format == CAIRO_FORMAT_ARGB32 || format == CAIRO_FORMAT_RGB24) &&
+                 header.width > 0 && header.height > 0 &&
+                 static_cast<int>(header.stride) == cairo_format_stride_for_width(format, header.width) &&
+                 size >= raw_data_offset + static_cast<size_t>(header.stride) * header.height;
+
+    if (!valid) {
+        munmap(mapping, size);
+        return false;
+    }
+
+    auto data = static_cast<unsigned char*>(mapping) + raw_data_offset;
+    surface_ = cairo_image_surface_create_for_data(data, format, header.width, header.height, header.stride);
+    if (cairo_surface_status(surface_) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface_);
+        surface_ = nullptr;
+        munmap(mapping, size);
+        return false;
+    }
+
+    mapping_ = mapping;
+    mapping_size_ = size;
+
+    cr_ = cairo_create(surface_);
+    width_ = static_cast<double>(header.width);
+    height_ = static_cast<double>(header.height);
+
+    return true;
+}
+
+void surface::write_raw(std::string path)
+{
+    if (surface_ == nullptr) {
+        return;
+    }
+
+    cairo_surface_flush(surface_);
+
+    raw_header header{};
+    memcpy(header.magic, raw_magic, sizeof(raw_magic));
+    header.format = static_cast<uint32_t>(cairo_image_surface_get_format(surface_));
+    header.width = cairo_image_surface_get_width(surface_);
+    header.height = cairo_image_surface_get_height(surface_);
+    header.stride = cairo_image_surface_get_stride(surface_);
+
+    auto data = cairo_image_surface_get_data(surface_);
+    if (data == nullptr) {
+        return;
+    }
+
+    char padding[raw_data_offset]{};
+    memcpy(padding, &header, sizeof(header));
+
+    // Written under a unique temporary name so that a reader never maps a
+    // partially written file
+    std::string tmp_path = path + ".XXXXXX";
+    int fd = mkstemp(&tmp_path[0]);
+    if (fd == -1) {
+        return;
+    }
+    close(fd);
+
+    std::ofstream f(tmp_path, std::ios::out|std::ios::binary|std::ios::trunc);
+    if (!f.is_open()) {
+        unlink(tmp_path.c_str());
+        return;
+    }
+
+    f.write(padding, sizeof(padding));
+    f.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(header.stride) * header.height);
+    f.close();
+
+    if (!f) {
+        unlink(tmp_path.c_str());
+        return;
+    }
+
+    printf("Writing %s\n", path.c_str());
+    rename(tmp_path.c_str(), path.c_str());
+}
+
+void surface::load_highlight(std::shared_ptr<surface> asset, const highlight_style& style)
+{
+    if (asset == nullptr || asset->handle() == nullptr) {
+        return;
+    }
+
+    int width = style.width > 0 ? static_cast<int>(std::round(style.width)) : cairo_image_surface_get_width(asset->handle());
+    int height = style.height > 0 ? static_cast<int>(std::round(style.height)) : cairo_image_surface_get_height(asset->handle());
+
+    surface_ = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+    cr_ = cairo_create(surface_);
+    width_ = static_cast<double>(width);
+    height_ = static_cast<double>(height);
+
+    cairo_set_source_rgb(cr_, style.bg_r, style.bg_g, style.bg_b);
+    cairo_paint(cr_);
+
+    cairo_set_source_surface(cr_, asset->handle(), 0, 0);
+    cairo_paint(cr_);
+
+    if (style.overlay_alpha > 0) {
+        cairo_set_source_rgba(cr_, style.overlay_r, style.overlay_g, style.overlay_b, style.overlay_alpha);
+        cairo_rectangle(cr_, 0, 0, std::min(style.overlay_width, width_), std::min(style.overlay_height, height_));
+        cairo_fill(cr_);
+    }
+}
+
+void surface::load_text(std::string text, const text_style& style)
+{
+    // Measure on a scratch context, the extents depend on the font only
+    auto scratch = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+    auto scratch_cr = cairo_create(scratch);
+    cairo_select_font_face(scratch_cr, style.face.c_str(), style.slant, style.weight);
+    cairo_set_font_size(scratch_cr, style.size);
+
+    cairo_text_extents_t extents;
+    cairo_text_extents(scratch_cr, text.c_str(), &extents);
+
+    cairo_destroy(scratch_cr);
+    cairo_surface_destroy(scratch);
+
+    if (extents.width <= 0 || extents.height <= 0) {
+        return;
+    }
+
+    // One pixel of margin for antialiasing
+    origin_x_ = std::floor(extents.x_bearing) - 1;
+    origin_y_ = std::floor(extents.y_bearing) - 1;
+    int width = static_cast<int>(std::ceil(extents.x_bearing + extents.width) - origin_x_) + 1;
+    int height = static_cast<int>(std::ceil(extents.y_bearing + extents.height) - origin_y_) + 1;
+
+    surface_ = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cr_ = cairo_create(surface_);
+    width_ = static_cast<double>(width);
+    height_ = static_cast<double>(height);
+
+    cairo_select_font_face(cr_, style.face.c_str(), style.slant, style.weight);
+    cairo_set_font_size(cr_, style.size);
+    cairo_set_source_rgb(cr_, style.r, style.g, style.b);
+    cairo_move_to(cr_, -origin_x_, -origin_y_);
+    cairo_show_text(cr_, text.c_str());
+}
+
 void surface::write_png(std::string path)
 {
     if (surface_ != nullptr) {
@@ -159,6 +365,15 @@ void surface::write_png(std::string path)
     }
 }
 
+size_t surface::byte_size()
+{
+    if (surface_ == nullptr) {
+        return 0;
+    }
+
+    return static_cast<size_t>(cairo_image_surface_get_stride(surface_)) * cairo_image_surface_get_height(surface_);
+}
+
 void surface::fill(double r, double g, double b) {
     if (cr_ == nullptr) {
         return;
@@ -169,14 +384,38 @@ void surface::fill(double r, double g, double b) {
     cairo_fill(cr_);
 }
 
-void surface::draw_surface(std::shared_ptr<surface> surface, double x, double y, double alpha)
+uint64_t surface::blit(std::shared_ptr<surface> src, double x, double y, double alpha)
 {
-    if (cr_ == nullptr) {
-        return;
+    if (cr_ == nullptr || src == nullptr || src->handle() == nullptr || alpha <= 0) {
+        return 0;
     }
 
-    cairo_set_source_surface (cr_, surface->handle(), x, y);
-    cairo_paint_with_alpha (cr_, alpha);
-    cairo_paint(cr_);
-}
+    double src_width = static_cast<double>(cairo_image_surface_get_width(src->handle()));
+    double src_height = static_cast<double>(cairo_image_surface_get_height(src->handle()));
 
+    // An opaque source replaces the destination so blending can be skipped.
+    // Snap it to the pixel grid, a fractional position would blend the edges
+    bool opaque = alpha >= 1.0 && cairo_surface_get_content(src->handle()) == CAIRO_CONTENT_COLOR;
+    if (opaque) {
+        x = std::round(x);
+        y = std::round(y);
+    }
+
+    cairo_save(cr_);
+    cairo_set_operator(cr_, opaque ? CAIRO_OPERATOR_SOURCE : CAIRO_OPERATOR_OVER);
+    cairo_set_source_surface(cr_, src->handle(), x, y);
+    cairo_rectangle(cr_, x, y, src_width, src_height);
+    cairo_clip(cr_);
+
+    if (alpha >= 1.0) {
+        cairo_paint(cr_);
+    } else {
+        cairo_paint_with_alpha(cr_, alpha);
+    }
+
+    double x1, y1, x2, y2;
+    cairo_clip_extents(cr_, &x1, &y1, &x2, &y2);
+    cairo_restore(cr_);
+
+    return static_cast<uint64_t>((x2 - x1) * (y2 - y1));
+}
@@ -17,28 +17,148 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
 #include <vector>
 #include <sys/stat.h>
 #include <unistd.h>
-#include <pthread.h>
-#include <unistd.h>
 #include <sys/types.h>
 #include <pwd.h>
-#include <unistd.h>
-#include <sys/types.h>
 #include <string>
+#include <sstream>
 #include <stdio.h>
 
-
-static pthread_mutex_t utils_basename_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 #include <graphics_context/surface_cache.hpp>
 
-surface_cache::surface_cache(int screen_width, int screen_height)
-    : screen_width_(screen_width)
+surface_cache::surface_cache(int screen_width, int screen_height, size_t memory_budget)
+    : memory_budget_(memory_budget)
+    , screen_width_(screen_width)
     , screen_height_(screen_height)
 {
+    // Persistent cache directory. Already existing is fine
+    mkdir(get_dino_root().c_str(), 0755);
+}
+
+surface_cache::~surface_cache()
+{
+    for(auto&& worker : workers_) {
+        worker.join();
+    }
+}
+
+void surface_cache::warm_up(std::vector<cache_asset> assets)
+{
+    for(auto&& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    warm_up_assets_ = assets;
+    warm_up_next_ = 0;
+    warm_up_done_ = 0;
+
+    size_t nr_workers = std::max(1u, std::thread::hardware_concurrency());
+    nr_workers = std::min(nr_workers, warm_up_assets_.size());
+
+    for(size_t i=0; i<nr_workers; i++) {
+        workers_.emplace_back(&surface_cache::warm_up_worker, this);
+    }
+}
+
+void surface_cache::warm_up_worker()
+{
+    while (true) {
+        size_t idx = warm_up_next_++;
+        if (idx >= warm_up_assets_.size()) {
+            return;
+        }
 
+        auto& asset = warm_up_assets_[idx];
+        if (asset.width > 0 && asset.height > 0) {
+            get_svg_surface(asset.path, asset.width, asset.height);
+        } else {
+            get_png_surface(asset.path);
+        }
+
+        warm_up_done_++;
+    }
+}
+
+std::shared_ptr<surface> surface_cache::lookup_or_reserve(const surface_key& key)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Another thread is creating this surface
+    released_.wait(lock, [&] { return in_progress_.count(key) == 0; });
+
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        hits_++;
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+        return it->second.cached_surface;
+    }
+
+    misses_++;
+    in_progress_.insert(key);
+    return nullptr;
+}
+
+void surface_cache::release(const surface_key& key, std::shared_ptr<surface> s)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (s != nullptr && cache_.find(key) == cache_.end()) {
+        lru_.push_front(key);
+
+        cache_entry entry;
+        entry.cached_surface = s;
+        entry.bytes = s->byte_size();
+        entry.lru_position = lru_.begin();
+        cache_[key] = entry;
+
+        bytes_ += entry.bytes;
+        evict();
+    }
+
+    in_progress_.erase(key);
+    released_.notify_all();
+}
+
+void surface_cache::evict()
+{
+    if (memory_budget_ == 0) {
+        return;
+    }
+
+    auto it = lru_.end();
+    while (bytes_ > memory_budget_ && it != lru_.begin()) {
+        --it;
+
+        auto entry = cache_.find(*it);
+        if (entry->second.cached_surface.use_count() > 1) {
+            continue;
+        }
+
+        bytes_ -= entry->second.bytes;
+        evictions_++;
+        cache_.erase(entry);
+        it = lru_.erase(it);
+    }
+}
+
+surface_cache_stats surface_cache::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    surface_cache_stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.entries = cache_.size();
+    stats.bytes = bytes_;
+    return stats;
 }
 
 surface_key surface_cache::create_key(std::string path, double width, double height)
@@ -54,20 +174,6 @@ surface_cache::path_exists(const std::string& path)
     return (stat(path.c_str(), &buffer) == 0);
 }
 
-std::string
-surface_cache::utils_basename(std::string path)
-{
-    char* dup_str = strdup(path.c_str()); // path may be const
-
-    pthread_mutex_lock(&utils_basename_mutex);
-    std::string base_name = std::string(basename(dup_str));
-    pthread_mutex_unlock(&utils_basename_mutex);
-
-    free(dup_str);
-
-    return base_name;
-}
-
 std::string surface_cache::get_home_path()
 {
     std::string path = "/";
@@ -86,15 +192,41 @@ std::string surface_cache::get_home_path()
 }
 
 
+// FNV-1a, 0 if the file cannot be read
+static uint64_t content_hash(const std::string& path)
+{
+    std::ifstream f(path, std::ios::in|std::ios::binary);
+    if (!f.is_open()) {
+        return 0;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325;
+    char buffer[65536];
+    while (f.read(buffer, sizeof(buffer)) || f.gcount() > 0) {
+        for(std::streamsize i=0; i<f.gcount(); i++) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 0x100000001b3;
+        }
+    }
+
+    return hash;
+}
+
 std::string surface_cache::get_cache_filename(std::string path, double width, double height)
 {
-    auto filename = utils_basename(path);
-    filename += ".cache_";
-    filename += std::to_string(screen_width_) + "_";
-    filename += std::to_string(screen_height_) + "_";
-    filename += std::to_string(static_cast<int>(width)) + "_";
-    filename += std::to_string(static_cast<int>(height)) + ".png";
-    return filename;
+    // Keyed by content rather than name so that an updated asset is
+    // rendered again instead of picking up a stale cache file
+    auto hash = content_hash(path);
+    if (hash == 0) {
+        return "";
+    }
+
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0') << std::setw(16) << hash << std::dec;
+    oss << "_" << static_cast<int>(width) << "x" << static_cast<int>(height);
+    oss << "_" << std::fixed << std::setprecision(3) << surface::svg_dpi(width);
+    oss << ".argb32";
+    return oss.str();
 }
 
 std::string surface_cache::get_dino_root()
@@ -103,102 +235,140 @@ std::string surface_cache::get_dino_root()
     return home_path + "/.hydrotopia_ui";
 }
 
-void surface_cache::update_persistent_png_cache(std::string path, double width, double height, std::shared_ptr<surface> surface)
+void surface_cache::update_persistent_cache(std::string cache_filename, std::shared_ptr<surface> surface)
 {
+    if (cache_filename.empty()) {
+        return;
+    }
 
-    std::string cmd = "mkdir -p " + get_dino_root();
-    system(cmd.c_str());
-    std::string cache_path = get_dino_root() + "/" + get_cache_filename(path, width, height);
+    std::string cache_path = get_dino_root() + "/" + cache_filename;
 
     if (path_exists(cache_path)) {
         return;
     }
 
-    surface->write_png(cache_path.c_str());
+    surface->write_raw(cache_path);
 }
 
-std::shared_ptr<surface> surface_cache::load_from_persistent_cache(std::string path, double width, double height)
+std::shared_ptr<surface> surface_cache::load_from_persistent_cache(std::string cache_filename)
 {
-    auto cache_filename = get_cache_filename(path, width, height);
-    std::string cache_path = get_dino_root() + "/" + cache_filename;
+    if (cache_filename.empty()) {
+        return nullptr;
+    }
 
-    if (!path_exists(cache_path)) {
+    auto s = std::shared_ptr<surface>(new surface());
+    if (!s->load_from_raw(get_dino_root() + "/" + cache_filename)) {
         return nullptr;
     }
 
-    return get_png_surface(cache_path);
+    return s;
 }
 
 std::shared_ptr<surface> surface_cache::get_svg_surface(std::string path, double width, double height)
 {
-    //purge_outdated_entries();
-
     auto key = create_key(path, width, height);
 
     // Already available
-    if (cache_.find(key) != cache_.end()) {
-        cache_[key].last_accessed = get_ts();
-        return cache_[key].cached_surface;
+    auto s = lookup_or_reserve(key);
+    if (s != nullptr) {
+        return s;
     }
 
-    auto s = load_from_persistent_cache(path, width, height);
+    auto cache_filename = get_cache_filename(path, width, height);
+    s = load_from_persistent_cache(cache_filename);
     if (s == nullptr) {
         // Create
         s = std::shared_ptr<surface>(new surface(width, height));
         s->load_from_svg(path);
-        update_persistent_png_cache(path, width, height, s);
-
-        // Populate cache   
-        cache_entry entry;
-        entry.last_accessed = get_ts();
-        entry.cached_surface = s;
-        cache_[key] = entry;
+        update_persistent_cache(cache_filename, s);
     }
 
+    // Populate cache
+    release(key, s);
+
     return s;
 }
 
 std::shared_ptr<surface> surface_cache::get_png_surface(std::string path)
 {
-    //purge_outdated_entries();
-
     auto key = create_key(path, 0, 0);
 
     // Already available
-    if (cache_.find(key) != cache_.end()) {
-        cache_[key].last_accessed = get_ts();
-        return cache_[key].cached_surface;
+    auto s = lookup_or_reserve(key);
+    if (s != nullptr) {
+        return s;
     }
 
     // Create
-    auto s = std::shared_ptr<surface>(new surface());
+    s = std::shared_ptr<surface>(new surface());
     s->load_from_png(path);
 
     // Populate cache
-    cache_entry entry;
-    entry.last_accessed = get_ts();
-    entry.cached_surface = s;
-    cache_[key] = entry;
+    release(key, s);
 
     return s;
 }
 
-void surface_cache::purge_outdated_entries()
+std::shared_ptr<surface> surface_cache::get_text_surface(std::string text, const text_style& style)
 {
-    std::vector<std::string> keys_to_remove;
+    std::ostringstream oss;
+    oss << "text_" << style.face << "_" << style.slant << "_" << style.weight;
+    for(auto v : { style.size, style.r, style.g, style.b }) {
+        oss << "_" << v;
+    }
+    oss << "_" << text;
+    auto key = oss.str();
 
-    for(auto&& e : cache_) {
-        auto key = e.first;
+    // Already available
+    auto s = lookup_or_reserve(key);
+    if (s != nullptr) {
+        return s;
+    }
 
-        auto elapsed_time_ms = (get_ts() - e.second.last_accessed) / 1000;
-        if (elapsed_time_ms > 60000) {
-            keys_to_remove.emplace_back(key);
-            e.second.cached_surface = nullptr;
-        }
+    // Create
+    s = std::shared_ptr<surface>(new surface());
+    s->load_text(text, style);
+
+    // Populate cache
+    release(key, s);
+
+    return s;
+}
+
+std::shared_ptr<surface> surface_cache::get_svg_highlight_surface(std::string path, double width, double height, const highlight_style& style)
+{
+    return get_highlight_surface(create_key(path, width, height), get_svg_surface(path, width, height), style);
+}
+
+std::shared_ptr<surface> surface_cache::get_png_highlight_surface(std::string path, const highlight_style& style)
+{
+    return get_highlight_surface(create_key(path, 0, 0), get_png_surface(path), style);
+}
+
+std::shared_ptr<surface> surface_cache::get_highlight_surface(surface_key asset_key, std::shared_ptr<surface> asset, const highlight_style& style)
+{
+    std::ostringstream oss;
+    oss << asset_key << "_highlight";
+    for(auto v : { style.width, style.height,
+                   style.bg_r, style.bg_g, style.bg_b,
+                   style.overlay_r, style.overlay_g, style.overlay_b, style.overlay_alpha,
+                   style.overlay_width, style.overlay_height }) {
+        oss << "_" << v;
     }
+    auto key = oss.str();
 
-    for(auto&& key : keys_to_remove) {
-        cache_.erase(key);
+    // Already available
+    auto s = lookup_or_reserve(key);
+    if (s != nullptr) {
+        return s;
     }
-}
 
+    // Create
+    s = std::shared_ptr<surface>(new surface());
+    s->load_highlight(asset, style);
+
+    // Populate cache
+    release(key, s);
+
+    return s;
+}
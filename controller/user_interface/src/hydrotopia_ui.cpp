@@ -17,6 +17,7 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
@@ -34,14 +35,12 @@
 #include <scene/02_security/keypad_scene.hpp>
 #include <scene/03_settings/settings_scene.hpp>
 
-hydrotopia_ui::hydrotopia_ui(int screen_width, int screen_height, bool fullscreen)
+hydrotopia_ui::hydrotopia_ui(int screen_width, int screen_height, bool fullscreen, size_t cache_budget)
  : screen_width_(screen_width)
  , screen_height_(screen_height)
  , fullscreen_(fullscreen)
+ , cache_budget_(cache_budget)
 {
-    target_fps_ = 120;
-    current_fps_ = target_fps_;
-
     start_ts_ = get_ts();
 }
 
@@ -61,6 +60,7 @@ void hydrotopia_ui::scene_init()
     scene_idx_ = 0;
     scenes_[scene_idx_]->end();
     scenes_[scene_idx_]->invalidate();
+    scenes_initialized_ = true;
 }
 
 bool hydrotopia_ui::check_ui_events()
@@ -70,15 +70,12 @@ bool hydrotopia_ui::check_ui_events()
     for(auto&& event : events) {
         switch (event->get_type()) {
             case ui_event_type::expose: {
+                ctx_->damage_all();
                 scenes_[scene_idx_]->invalidate();
+                invalidate_on_screen_display();
+                initial_expose_event_ = true;
                 draw_scene();
                 scene_updated = true;
-
-                if (!initial_expose_event_) {
-                  scene_init();
-                  scene_updated = false;
-                  initial_expose_event_ = true;
-                }
                 break;
             }
             case ui_event_type::key_press: {
@@ -100,6 +97,10 @@ bool hydrotopia_ui::check_ui_events()
 
                 break;
             }
+            case ui_event_type::close: {
+                exit_ = true;
+                break;
+            }
             case ui_event_type::pointer_motion:
             case ui_event_type::button_press: {
                 // Update mouse coordinates (inverted scaling)
@@ -121,12 +122,23 @@ void hydrotopia_ui::draw_scene()
 {
     auto scene = scenes_[scene_idx_];
 
+    // Splash screen until the asset cache is warm. The remaining scenes
+    // then find their surfaces in the cache
+    if (!scenes_initialized_) {
+        scene->draw();
+        if (initial_expose_event_ && scene->ended()) {
+            scene_init();
+        }
+        return;
+    }
+
     if (scene->idle_screen()) {
         scene->reset();
         scene_idx_ = 1;
         scene = scenes_[scene_idx_];
         scene->invalidate();
         scene->begin();
+        invalidate_on_screen_display();
     } else if (scene->ended()) {
         // Last scene. Rewind
         if (scenes_.find(scene_idx_ + 1) == scenes_.end()) {
@@ -142,6 +154,7 @@ void hydrotopia_ui::draw_scene()
         scene = new_scene;
         scene->invalidate();
         scene->begin();
+        invalidate_on_screen_display();
     } 
 
     if (scene_idx_ == 2) {
@@ -151,13 +164,15 @@ void hydrotopia_ui::draw_scene()
     }
 
     // On screen display (debug)
-    if (osd_) {
-        draw_on_screen_display();
-    } else if (scene_idx_ >= 2) {
+    if (!osd_ && !osd_text_.empty()) {
         clear_on_screen_display();
     }
 
     scene->draw();
+
+    if (osd_) {
+        draw_on_screen_display();
+    }
 }
 
 void hydrotopia_ui::draw_scene(ui_event ev)
@@ -171,13 +186,31 @@ void hydrotopia_ui::draw_scene(ui_event ev)
     }
 
     // On screen display (debug)
-    if (osd_) {
-        draw_on_screen_display();
-    } else if (scene_idx_ >= 2) {
+    if (!osd_ && !osd_text_.empty()) {
         clear_on_screen_display();
     }
 
     scene->draw(ev);
+
+    if (osd_) {
+        draw_on_screen_display();
+    }
+}
+
+int64_t hydrotopia_ui::next_deadline()
+{
+    auto deadline = scenes_[scene_idx_]->deadline();
+
+    // On screen display clock has minute resolution
+    if (osd_) {
+        time_t t = time(nullptr);
+        auto next_minute = get_ts() + (60 - t % 60) * 1000000;
+        if (deadline == 0 || next_minute < deadline) {
+            deadline = next_minute;
+        }
+    }
+
+    return deadline;
 }
 
 std::string hydrotopia_ui::elapsed_time_str(int64_t elapsed_time) {
@@ -211,21 +244,35 @@ void hydrotopia_ui::clear_on_screen_display()
     ctx_->set_source_rgb(1, 1, 1);
     ctx_->rectangle(1405, 1520, 750, 100);
     ctx_->fill();
+
+    osd_surface_.reset();
+    invalidate_on_screen_display();
 }
 
-void hydrotopia_ui::draw_on_screen_display()
+void hydrotopia_ui::invalidate_on_screen_display()
 {
-    auto elapsed_time = get_ts() - start_ts_;
-    auto elapsed_str = elapsed_time_str(elapsed_time);
+    osd_second_ = 0;
+    osd_text_.clear();
+}
 
+void hydrotopia_ui::draw_on_screen_display()
+{
+    // Only drawn when the displayed text changes
     time_t t = time(nullptr);
+    if (t == osd_second_) {
+        return;
+    }
+    osd_second_ = t;
+
     auto ts = std::string(asctime(localtime(&t)));
     for(int i=0; i<9; i++) {
         ts.pop_back();
     }
 
-    std::ostringstream oss;
-    oss << ts;
+    if (ts == osd_text_) {
+        return;
+    }
+    osd_text_ = ts;
 
     ctx_->set_source_rgb(1, 1, 1);
     ctx_->rectangle(1405, 1520, 750, 100);
@@ -234,7 +281,12 @@ void hydrotopia_ui::draw_on_screen_display()
     ctx_->set_source_rgb(0, 0, 0);
     ctx_->move_to(1450, 1585);
     ctx_->font_size(75);
-    ctx_->show_text(oss.str());
+
+    // The clock text changes every minute, so it is rendered outside the
+    // surface cache and only the current surface is kept
+    osd_surface_ = std::shared_ptr<surface>(new surface());
+    osd_surface_->load_text(osd_text_, ctx_->current_text_style());
+    ctx_->show_text(osd_surface_);
 }
 
 void hydrotopia_ui::run()
@@ -248,52 +300,60 @@ void hydrotopia_ui::run()
 
     ctx_->font_face("Lato Black", font_slant::normal, font_weight::normal);
 
-    sur_cache_ = std::make_shared<surface_cache>(surface_cache(screen_width_, screen_height_));
+    sur_cache_ = std::make_shared<surface_cache>(screen_width_, screen_height_, cache_budget_);
 
     // Display splash screen while loading background
     scenes_[scene_idx_] = std::make_shared<cache_generation_scene>(cache_generation_scene(ctx_, sur_cache_));
     scene_idx_ = 0;
+    scenes_[scene_idx_]->begin();
 
-    auto screen_update_timer = timer();
-    double period = 1000.0 / target_fps_;
-    auto timer_id = screen_update_timer.register_one_shot_timer(std::chrono::milliseconds(static_cast<int>(period)));
+    // Sleep until there is X input or a time based update is due (scene
+    // timeout, on screen display clock). Nothing is drawn while idle
+    auto event_loop = timer();
+    event_loop.register_fd(screen_->connection_fd());
+    auto deadline_timer_id = event_loop.register_timer();
+    int64_t armed_deadline = 0;
+    bool redraw = true;
 
     while(!exit_) {
-        auto events = screen_update_timer.wait_for_events();
-        for(auto&& event : events) {
-            if (event->id() != timer_id) {
-                continue;
+        if (!redraw && !screen_->events_pending()) {
+            auto deadline = next_deadline();
+            if (deadline != armed_deadline) {
+                if (deadline == 0) {
+                    event_loop.disarm(deadline_timer_id);
+                } else {
+                    auto remaining = std::chrono::microseconds(deadline - get_ts());
+                    event_loop.arm(deadline_timer_id, remaining, std::chrono::microseconds(0));
+                }
+                armed_deadline = deadline;
             }
-            auto ts1 = get_ts();
 
-            auto scene_updated = check_ui_events();
-            if (!scene_updated) {
-                draw_scene();
+            for(auto event : event_loop.wait_for_events()) {
+                if (event.id() == deadline_timer_id) {
+                    armed_deadline = 0;
+                }
             }
+        }
 
-            auto ts2 = get_ts();
-            auto diff = ts2 - ts1;
+        auto scene_updated = check_ui_events();
+        if (!scene_updated) {
+            draw_scene();
+        }
 
-            double expected_period = 1000000.0 / current_fps_;
-            if (diff > expected_period * 1.1) {
-                current_fps_ /= diff / expected_period;
-                    if (current_fps_ < 1) {
-                        current_fps_ = 1;
-                    }
-                } else {
-                    if (current_fps_ < target_fps_) {
-                        current_fps_ *= expected_period / diff;
-                    }
-                    if (current_fps_ > target_fps_) {
-                        current_fps_ = target_fps_;
-                    }
-            }
+        ctx_->present();
 
-            period = 1000.0 / current_fps_;
-            timer_id = screen_update_timer.register_one_shot_timer(std::chrono::milliseconds(static_cast<int>(period)));
-        }
+        // Scene transitions are carried out by the next draw_scene()
+        auto scene = scenes_[scene_idx_];
+        redraw = scenes_initialized_ && (scene->ended() || scene->idle_screen());
     }
 
+    auto stats = sur_cache_->stats();
+    printf("Surface cache: %zu entries, %zu KiB, %llu hits, %llu misses, %llu evictions\n",
+           stats.entries, stats.bytes / 1024,
+           (unsigned long long)stats.hits,
+           (unsigned long long)stats.misses,
+           (unsigned long long)stats.evictions);
+
     screen_->close();
 }
 
@@ -22,6 +22,7 @@
 #include <sstream>
 
 #include <hydrotopia_ui.hpp>
+#include <render_benchmark.hpp>
 
 //-------------------------------------------------------------------------------------------------------------------
 
@@ -32,8 +33,10 @@ constexpr int default_screen_height = 1600;
 
 static bool g_fullscreen = false;
 static bool g_help = false;
+static bool g_render_benchmark = false;
 static int g_screen_width = default_screen_width;
 static int g_screen_height = default_screen_height;
+static size_t g_cache_budget = surface_cache::default_memory_budget;
 
 //-------------------------------------------------------------------------------------------------------------------
 
@@ -42,17 +45,21 @@ enum cli_option
     cli_option_fullscreen = 1000, // value higher thann short options
     cli_option_screen_width,
     cli_option_screen_height,
+    cli_option_render_benchmark,
+    cli_option_cache_budget,
     cli_option_help,
 };
 
 //-------------------------------------------------------------------------------------------------------------------
 
 static struct option long_options[] = {
-    { "fullscreen",     no_argument,       nullptr,  cli_option_fullscreen    },
-    { "screen-width",   required_argument, nullptr,  cli_option_screen_width  },
-    { "screen-height",  required_argument, nullptr,  cli_option_screen_height },
-    { "help",           no_argument,       nullptr,  cli_option_help          },
-    { nullptr,          0,                 nullptr,  0                        }
+    { "fullscreen",       no_argument,       nullptr,  cli_option_fullscreen       },
+    { "screen-width",     required_argument, nullptr,  cli_option_screen_width     },
+    { "screen-height",    required_argument, nullptr,  cli_option_screen_height    },
+    { "render-benchmark", no_argument,       nullptr,  cli_option_render_benchmark },
+    { "cache-budget",     required_argument, nullptr,  cli_option_cache_budget     },
+    { "help",             no_argument,       nullptr,  cli_option_help             },
+    { nullptr,            0,                 nullptr,  0                           }
 };
 
 //-------------------------------------------------------------------------------------------------------------------
@@ -86,6 +93,14 @@ parse_arguments(int argc, char* argv[])
                 g_screen_height = (int)strtol(optarg, nullptr, 10);
                 break;
 
+            case cli_option_render_benchmark:
+                g_render_benchmark = true;
+                break;
+
+            case cli_option_cache_budget:
+                g_cache_budget = (size_t)strtoul(optarg, nullptr, 10) * 1024 * 1024;
+                break;
+
             case 'h':
             case cli_option_help:
                 g_help = true;
@@ -111,6 +126,8 @@ print_help()
     ss << " -f --fullscreen-games   Fullscreen mode" << std::endl;
     ss << "    --screen-width=INT   Screen width (default " << default_screen_width << ")" << std::endl;
     ss << "    --screen-height=INT  Screen height (default " << default_screen_height << ")" << std::endl;
+    ss << "    --render-benchmark   Measure offscreen frame composition and exit" << std::endl;
+    ss << "    --cache-budget=MIB   Surface cache memory budget, 0 is unbounded (default " << surface_cache::default_memory_budget / (1024 * 1024) << ")" << std::endl;
     ss << " -h --help               Show this help screen" << std::endl;
     // clang-format on
 
@@ -132,9 +149,15 @@ int main(int argc, char* argv[])
         return EXIT_SUCCESS;
     }
 
+    if (g_render_benchmark) {
+        render_benchmark(g_screen_width, g_screen_height);
+        return EXIT_SUCCESS;
+    }
+
     auto game = hydrotopia_ui(g_screen_width,
                           g_screen_height,
-                          g_fullscreen);
+                          g_fullscreen,
+                          g_cache_budget);
 
     game.run();
 
@@ -59,19 +59,28 @@ void image_object::internal_draw()
         return;
     }
 
-    ctx_->draw_surface(surface_, state_.x, state_.y, 1);
-    ctx_->set_source_rgba(0,0,0,state_.alpha);
-    ctx_->rectangle(state_.x,
-                    state_.y,
-                    state_.width,
-                    state_.height);
-    ctx_->fill();
+    // Image on white with the darkening overlay of the highlight level
+    // pre-composited into a single opaque surface
+    highlight_style style;
+    style.width = 0;
+    style.height = 0;
+    style.bg_r = 1;
+    style.bg_g = 1;
+    style.bg_b = 1;
+    style.overlay_r = 0;
+    style.overlay_g = 0;
+    style.overlay_b = 0;
+    style.overlay_alpha = state_.alpha;
+    style.overlay_width = ctx_->scale(state_.width);
+    style.overlay_height = ctx_->scale(state_.height);
+
+    ctx_->blit(sur_cache_->get_png_highlight_surface(png_path_, style), state_.x, state_.y, 1);
 
     if (hover_ || selected_) {
         ctx_->move_to(state_.x, state_.y + state_.height + 20);
         ctx_->set_source_rgb(1.0, 0.834, 0.168);
         ctx_->font_size(25);
-        ctx_->show_text(dino_name_.c_str());
+        ctx_->show_text(sur_cache_->get_text_surface(dino_name_, ctx_->current_text_style()));
     }
 }
 
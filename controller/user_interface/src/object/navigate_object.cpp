@@ -125,144 +125,109 @@ void navigate_object::set_highlight_on(double value)
     state_.alpha = highlight_on_;
 }
 
-void navigate_object::internal_draw()
+std::shared_ptr<surface> navigate_object::highlight_surface(double alpha)
 {
-    ctx_->set_source_rgb(1,1,1);
-    ctx_->rectangle(state_.x,
-                    state_.y,
-                    state_.width,
-                    state_.height);
-    ctx_->fill();
+    if (svg_path_.empty()) {
+        return nullptr;
+    }
+
+    // White backdrop and white overlay, faded by the highlight level
+    highlight_style style;
+    style.width = ctx_->scale(state_.width);
+    style.height = ctx_->scale(state_.height);
+    style.bg_r = 1;
+    style.bg_g = 1;
+    style.bg_b = 1;
+    style.overlay_r = 1;
+    style.overlay_g = 1;
+    style.overlay_b = 1;
+    style.overlay_alpha = alpha;
+    style.overlay_width = style.width;
+    style.overlay_height = style.height;
+
+    return sur_cache_->get_svg_highlight_surface(svg_path_,
+                                                 ctx_->scale(state_.width),
+                                                 ctx_->scale(state_.height),
+                                                 style);
+}
 
-    ctx_->draw_surface(surface_, state_.x, state_.y, 1);
-    ctx_->set_source_rgba(1,1,1,state_.alpha);
-    ctx_->rectangle(state_.x,
-                    state_.y,
-                    state_.width,
-                    state_.height);
-    ctx_->fill();
+void navigate_object::internal_draw()
+{
+    // Hover and selection only change the highlight level, each level is
+    // a pre-composited opaque surface
+    ctx_->blit(highlight_surface(state_.alpha), state_.x, state_.y, 1);
 
     state_.invalidate = false;
 }
 
 void navigate_object::load_svg()
 {
-    switch (nav_state_) {
-        case navigation_state::keypad_00:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_00.svg",
+    svg_path_ = svg_path(nav_state_);
+
+    if (svg_path_.empty()) {
+        surface_ = nullptr;
+        return;
+    }
+
+    surface_ = sur_cache_->get_svg_surface(svg_path_,
                                            ctx_->scale(state_.width),
                                            ctx_->scale(state_.height));
-            break;
+
+    // Render both highlight levels up front so that hovering never waits
+    highlight_surface(highlight_off_);
+    highlight_surface(highlight_on_);
+}
+
+std::string navigate_object::svg_path(navigation_state nav_state)
+{
+    switch (nav_state) {
+        case navigation_state::keypad_00:
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_00.svg";
         case navigation_state::keypad_01:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_01.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_01.svg";
         case navigation_state::keypad_02:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_02.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_02.svg";
         case navigation_state::keypad_03:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_03.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_03.svg";
         case navigation_state::keypad_04:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_04.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_04.svg";
         case navigation_state::keypad_05:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_05.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_05.svg";
         case navigation_state::keypad_06:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_06.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_06.svg";
         case navigation_state::keypad_07:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_07.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_07.svg";
         case navigation_state::keypad_08:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_08.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_08.svg";
         case navigation_state::keypad_09:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_09.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_09.svg";
         case navigation_state::keypad_star:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_star.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_star.svg";
         case navigation_state::keypad_hash:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/Keypad_button_hash.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/Keypad_button_hash.svg";
         case navigation_state::setting_off:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_off.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_off.svg";
         case navigation_state::setting_5m:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_5m.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_5m.svg";
         case navigation_state::setting_15m:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_15m.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_15m.svg";
         case navigation_state::setting_30m:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_30m.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_30m.svg";
         case navigation_state::setting_45m:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_45m.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_45m.svg";
         case navigation_state::setting_60m:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_60m.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_60m.svg";
         case navigation_state::setting_3h:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_3h.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_3h.svg";
         case navigation_state::setting_6h:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_6h.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_6h.svg";
         case navigation_state::setting_12h:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_12h.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_12h.svg";
         case navigation_state::setting_18h:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_button_18h.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_button_18h.svg";
         case navigation_state::setting_lock:
-            surface_ = sur_cache_->get_svg_surface("/usr/share/hydrotopia_ui/images/settings_lock.svg",
-                                           ctx_->scale(state_.width),
-                                           ctx_->scale(state_.height));
-            break;
+            return "/usr/share/hydrotopia_ui/images/settings_lock.svg";
     }
-}
 
+    return "";
+}
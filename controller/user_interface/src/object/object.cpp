@@ -31,6 +31,8 @@
     state_.height = height;
     state_.alpha = 1.0;
     state_.invalidate = true;
+
+    prev_state_ = state_;
 }
 
 bool object::intersect(object& obj)
@@ -51,6 +53,12 @@ bool object::state_changed()
     bool changed = state_.x != prev_state_.x || state_.y != prev_state_.y || 
         state_.alpha != prev_state_.alpha || state_.invalidate == true;
 
+    // Both the vacated and the new area need to reach the screen
+    if (changed) {
+        ctx_->damage(prev_state_.x, prev_state_.y, prev_state_.width, prev_state_.height);
+        ctx_->damage(state_.x, state_.y, state_.width, state_.height);
+    }
+
     prev_state_ = state_;
 
     return changed;
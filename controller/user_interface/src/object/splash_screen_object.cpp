@@ -38,7 +38,7 @@ void splash_screen_object::draw()
         return;
     }
 
-    ctx_->draw_surface(surface_, 0, 0, 1.0);
+    ctx_->blit(surface_, 0, 0, 1.0);
     state_.invalidate = false;
 }
 
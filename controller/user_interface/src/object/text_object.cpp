@@ -70,7 +70,7 @@ void text_object::draw()
     ctx_->move_to(state_.x , state_.y + (7 * (str_size_ / 10)));
     ctx_->set_source_rgb(0, 0, 0);
     ctx_->font_size(str_size_);
-    ctx_->show_text(str_.c_str());
+    ctx_->show_text(sur_cache_->get_text_surface(str_, ctx_->current_text_style()));
 
     state_.invalidate = false;
 }
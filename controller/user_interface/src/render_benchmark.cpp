@@ -0,0 +1,105 @@
+/*
+ *  Hydrotopia UI
+ * 
+ *  Copyright (C) 2024 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <common.hpp>
+#include <render_benchmark.hpp>
+#include <graphics_context/rendering_context.hpp>
+#include <user_interface/image_screen.hpp>
+
+constexpr int benchmark_frames = 100;
+constexpr int benchmark_sprites = 24;
+constexpr int benchmark_sprite_size = 256;
+
+static std::shared_ptr<surface> create_surface(cairo_format_t format, int width, int height)
+{
+    cairo_surface_t* image = cairo_image_surface_create(format, width, height);
+    return std::shared_ptr<surface>(new surface(image, cairo_create(image), static_cast<double>(width), static_cast<double>(height)));
+}
+
+// Composition as done by draw_surface before blit was introduced
+static uint64_t legacy_draw_surface(cairo_t* cr, std::shared_ptr<surface> src, double x, double y, double alpha)
+{
+    cairo_set_source_surface(cr, src->handle(), x, y);
+    cairo_paint_with_alpha(cr, alpha);
+    cairo_paint(cr);
+
+    return 2 * static_cast<uint64_t>(src->width() * src->height());
+}
+
+static void print_result(std::string name, int64_t elapsed, uint64_t pixels)
+{
+    std::cout << std::left << std::setw(24) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << static_cast<double>(elapsed) / 1000 / benchmark_frames << " ms/frame  "
+              << std::setw(8) << static_cast<double>(pixels) / 1000000 / benchmark_frames << " Mpixels/frame" << std::endl;
+}
+
+void render_benchmark(int screen_width, int screen_height)
+{
+    auto scr = std::make_shared<image_screen>(screen_width, screen_height);
+    auto ctx = std::make_shared<rendering_context>(scr, ref_width, ref_height, anti_aliasing::best);
+    auto cr = scr->root_surface()->cr();
+
+    // Opaque full screen background and translucent sprites on top,
+    // similar to the image objects of a scene
+    auto background = create_surface(CAIRO_FORMAT_RGB24, screen_width, screen_height);
+    background->fill(0.2, 0.5, 0.2);
+
+    auto sprite = create_surface(CAIRO_FORMAT_ARGB32, benchmark_sprite_size, benchmark_sprite_size);
+    cairo_set_source_rgba(sprite->cr(), 0.8, 0.4, 0.1, 0.9);
+    cairo_arc(sprite->cr(), benchmark_sprite_size / 2, benchmark_sprite_size / 2, benchmark_sprite_size / 2, 0, 2 * m_pi);
+    cairo_fill(sprite->cr());
+
+    std::vector<coordinate> positions;
+    for(int i=0; i<benchmark_sprites; i++) {
+        positions.push_back({ 100.0 + (i % 8) * 300.0, 200.0 + (i / 8) * 400.0 });
+    }
+
+    std::cout << "Render benchmark: " << screen_width << "x" << screen_height << ", "
+              << benchmark_sprites << " sprites, " << benchmark_frames << " frames" << std::endl;
+
+    uint64_t pixels = 0;
+    auto ts = get_ts();
+    for(int frame=0; frame<benchmark_frames; frame++) {
+        pixels += legacy_draw_surface(cr, background, 0, 0, 1.0);
+        for(auto&& pos : positions) {
+            pixels += legacy_draw_surface(cr, sprite, ctx->scale(pos.x), ctx->scale(pos.y), 1.0);
+        }
+        cairo_surface_flush(scr->root_surface()->handle());
+    }
+    print_result("draw_surface (legacy)", get_ts() - ts, pixels);
+
+    auto pixels_before = ctx->composited_pixels();
+    ts = get_ts();
+    for(int frame=0; frame<benchmark_frames; frame++) {
+        ctx->blit(background, 0, 0, 1.0);
+        for(auto&& pos : positions) {
+            ctx->blit(sprite, pos.x, pos.y, 1.0);
+        }
+        cairo_surface_flush(scr->root_surface()->handle());
+        ctx->present();
+    }
+    print_result("blit", get_ts() - ts, ctx->composited_pixels() - pixels_before);
+}
@@ -18,29 +18,87 @@
  */
 
 #include <memory>
+#include <sstream>
 
 #include <scene/00_cache_generation_scene/cache_generation_scene.hpp>
-#include <object/text_object.hpp>
+#include <object/navigate_object.hpp>
 #include <common.hpp>
 
 cache_generation_scene::cache_generation_scene(std::shared_ptr<rendering_context> ctx, std::shared_ptr<surface_cache> sur_cache)
   : scene(ctx, sur_cache)
 {
-  auto obj = std::shared_ptr<object>(new text_object(ctx_, sur_cache_, 520, 345, 1270, 25, "Loading...", 60));
-  objects_.emplace_back(obj);
+  progress_ = std::shared_ptr<text_object>(new text_object(ctx_, sur_cache_, 520, 345, 1270, 25, "Loading...", 60));
+  objects_.emplace_back(progress_);
 }
 
-void cache_generation_scene::draw()
+std::vector<cache_asset> cache_generation_scene::startup_assets()
 {
-    for(auto&& object : objects_) {
-        object->draw();
+    std::vector<cache_asset> assets;
+
+    // Keypad and settings buttons (all 320x160 reference size)
+    std::vector<navigation_state> buttons = {
+        navigation_state::keypad_00, navigation_state::keypad_01,
+        navigation_state::keypad_02, navigation_state::keypad_03,
+        navigation_state::keypad_04, navigation_state::keypad_05,
+        navigation_state::keypad_06, navigation_state::keypad_07,
+        navigation_state::keypad_08, navigation_state::keypad_09,
+        navigation_state::keypad_star, navigation_state::keypad_hash,
+        navigation_state::setting_off, navigation_state::setting_5m,
+        navigation_state::setting_15m, navigation_state::setting_30m,
+        navigation_state::setting_45m, navigation_state::setting_3h,
+        navigation_state::setting_6h, navigation_state::setting_12h,
+        navigation_state::setting_18h, navigation_state::setting_lock,
+    };
+
+    for(auto&& button : buttons) {
+        assets.push_back({navigate_object::svg_path(button), ctx_->scale(320), ctx_->scale(160)});
+    }
+
+    for(auto&& png : {"tree_02", "daily_channels", "hourly_channels", "grass", "garden"}) {
+        assets.push_back({std::string("/usr/share/hydrotopia_ui/images/") + png + ".png", 0, 0});
     }
+
+    return assets;
 }
 
-void cache_generation_scene::draw(ui_event ev)
+void cache_generation_scene::begin()
 {
+    if (!started_) {
+        sur_cache_->warm_up(startup_assets());
+        started_ = true;
+    }
+}
+
+int64_t cache_generation_scene::deadline()
+{
+    if (ended_) {
+        return 0;
+    }
+
+    return get_ts() + 100000;
+}
+
+void cache_generation_scene::draw()
+{
+    begin();
+
+    auto done = sur_cache_->warm_up_done();
+    auto total = sur_cache_->warm_up_total();
+
+    std::ostringstream oss;
+    oss << "Loading... " << done << "/" << total;
+    progress_->set_text(oss.str());
+
     for(auto&& object : objects_) {
         object->draw();
     }
+
+    if (done == total) {
+        ended_ = true;
+    }
 }
 
+void cache_generation_scene::draw(ui_event ev)
+{
+    draw();
+}
@@ -320,3 +320,14 @@ void keypad_scene::draw(ui_event ev)
 
   draw_counter_++;
 }
+
+int64_t keypad_scene::deadline()
+{
+    if (started_ts_ == 0) {
+        return 0;
+    }
+
+    // Just past the inactivity timeout checked in draw()
+    auto timeout = std::chrono::duration_cast<std::chrono::microseconds>(active_screen_timeout);
+    return started_ts_ + timeout.count() + 1000;
+}
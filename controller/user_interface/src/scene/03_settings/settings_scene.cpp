@@ -843,3 +843,14 @@ void settings_scene::draw(ui_event ev)
     }
   }
 }
+
+int64_t settings_scene::deadline()
+{
+    if (started_ts_ == 0) {
+        return 0;
+    }
+
+    // Just past the inactivity timeout checked in draw()
+    auto timeout = std::chrono::duration_cast<std::chrono::microseconds>(active_screen_timeout);
+    return started_ts_ + timeout.count() + 1000;
+}
@@ -17,12 +17,15 @@
  *  along with this program. If not, see <http://www.gnu.org/licenses/>
  */
 
+
+#include <errno.h>
 #include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <time.h>
 #include <sys/timerfd.h>
+#include <system_error>
 
 #include <timer.hpp>
 
@@ -31,84 +34,137 @@
 timer::timer()
 {
     epoll_setup();
+    events_.reserve(epoll_max_events);
+}
+
+//---------------------------------------------------------------------------------------------------------------------------
+
+timer::~timer()
+{
+    epoll_teardown();
 }
 
 //---------------------------------------------------------------------------------------------------------------------------
 
 uint64_t
-timer::register_one_shot_timer(std::chrono::milliseconds duration)
+timer::register_timer()
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "timerfd_create");
+    }
+
+    epoll_add(fd);
+
+    timer_id_++;
+    timer_map_[fd] = timer_id_;
+    return timer_id_;
+}
+
+//---------------------------------------------------------------------------------------------------------------------------
+
+void
+timer::arm(uint64_t id, std::chrono::microseconds initial, std::chrono::microseconds period)
 {
-    int timer_fd;
     struct itimerspec ts;
-    uint64_t res;
 
-    timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
-    if (timer_fd < 0) {
+    // A zero it_value would disarm the timer
+    if (initial.count() <= 0) {
+        initial = std::chrono::microseconds(1);
     }
 
-    ts.it_interval.tv_sec = 0;
-    ts.it_interval.tv_nsec = 0;
-    ts.it_value.tv_sec = duration.count() / 1000;
-    ts.it_value.tv_nsec = (duration.count() % 1000) * 1000000;
+    ts.it_value.tv_sec = initial.count() / 1000000;
+    ts.it_value.tv_nsec = (initial.count() % 1000000) * 1000;
+    ts.it_interval.tv_sec = period.count() / 1000000;
+    ts.it_interval.tv_nsec = (period.count() % 1000000) * 1000;
 
-    res = timerfd_settime(timer_fd, 0, &ts, NULL);
-    if (res < 0) {
+    if (timerfd_settime(timer_fd(id), 0, &ts, nullptr) < 0) {
+        throw std::system_error(errno, std::generic_category(), "timerfd_settime");
     }
+}
 
-    epoll_add(timer_fd);
+//---------------------------------------------------------------------------------------------------------------------------
 
-    timer_id_++;
-    timer_map_[timer_fd] = timer_id_;
-    return timer_id_;
+void
+timer::disarm(uint64_t id)
+{
+    struct itimerspec ts;
+    memset(&ts, 0, sizeof(ts));
+
+    if (timerfd_settime(timer_fd(id), 0, &ts, nullptr) < 0) {
+        throw std::system_error(errno, std::generic_category(), "timerfd_settime");
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------------
 
-std::shared_ptr<timer_event>
-timer::timerfd_handle_event(int fd)
+uint64_t
+timer::register_fd(int fd)
 {
-    char buffer[4096];
-    ssize_t len = read(fd, buffer, sizeof(buffer));
+    epoll_add(fd);
 
-    if (len <= 0) {
-        // throw exception
-    }
+    timer_id_++;
+    fd_map_[fd] = timer_id_;
+    return timer_id_;
+}
 
-    auto it = timer_map_.find(fd);
-    if (it != timer_map_.end()) {
-        uint64_t id = timer_map_[fd];
-        return std::shared_ptr<timer_event>(new timer_event(id));
+//---------------------------------------------------------------------------------------------------------------------------
+
+int
+timer::timer_fd(uint64_t id)
+{
+    for (auto&& [fd, timer_id] : timer_map_) {
+        if (timer_id == id) {
+            return fd;
+        }
     }
 
-    return nullptr;
+    throw std::system_error(EINVAL, std::generic_category(), "unknown timer id");
 }
 
 //---------------------------------------------------------------------------------------------------------------------------
 
-std::vector<std::shared_ptr<timer_event>>
+const std::vector<timer_event>&
 timer::wait_for_events()
 {
-    std::vector<std::shared_ptr<timer_event>> events;
-    struct epoll_event epoll_events[100];
-
-    while (events.size() == 0) {
-        int res = epoll_wait(epoll_fd_, epoll_events_, 100, -1);
-        if (res > 0) {
-            // Go through epoll events
-            for (int i = 0; i < res; i++) {
-                // Classify type of event and call handle function
-                int fd = epoll_events_[i].data.fd;
-                auto timer_event = timerfd_handle_event(fd);
-                events.push_back(timer_event);
-                close(fd);
+    events_.clear();
+
+    while (events_.empty()) {
+        int res = epoll_wait(epoll_fd_, epoll_events_, epoll_max_events, -1);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "epoll_wait");
+        }
+
+        for (int i = 0; i < res; i++) {
+            int fd = epoll_events_[i].data.fd;
+
+            auto it = fd_map_.find(fd);
+            if (it != fd_map_.end()) {
+                events_.emplace_back(it->second, 1);
+                continue;
+            }
+
+            // One read per expiry, yields the number of elapsed periods
+            uint64_t expirations = 0;
+            ssize_t len = read(fd, &expirations, sizeof(expirations));
+            if (len < 0) {
+                if (errno == EAGAIN) {
+                    continue; // re-armed after it became readable
+                }
+                throw std::system_error(errno, std::generic_category(), "read timerfd");
+            }
+
+            auto timer_it = timer_map_.find(fd);
+            if (timer_it != timer_map_.end() && len == sizeof(expirations)) {
+                events_.emplace_back(timer_it->second, expirations);
             }
-        } else if (res < 0) {
-            printf("epoll error\n");
-        } else {
-            perror("Timed Out");
         }
     }
-    return events;
+
+    return events_;
 }
 
 //---------------------------------------------------------------------------------------------------------------------------
@@ -118,6 +174,9 @@ timer::epoll_setup()
 {
     memset(&epoll_events_, 0, sizeof(epoll_events_));
     epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "epoll_create1");
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------------
@@ -131,6 +190,23 @@ timer::epoll_add(int fd)
     ev.data.fd = fd;
     int res = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
     if (res < 0) {
+        throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------------
+
+void
+timer::epoll_teardown()
+{
+    for (auto&& [fd, id] : timer_map_) {
+        close(fd);
+    }
+    timer_map_.clear();
+
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
     }
 }
 
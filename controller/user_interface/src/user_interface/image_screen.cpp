@@ -0,0 +1,29 @@
+/*
+ *  Hydrotopia UI
+ * 
+ *  Copyright (C) 2024 Johan Norberg <lonezor@gmail.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>
+ */
+
+
+#include <user_interface/image_screen.hpp>
+
+image_screen::image_screen(int width, int height)
+    : screen(width, height)
+{
+    cairo_surface_t* image = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+
+    root_surface_ = std::shared_ptr<surface>(new surface(image, cairo_create(image), static_cast<double>(width), static_cast<double>(height)));
+}
@@ -22,9 +22,19 @@
 #include <string.h>
 #include <iostream>
 #include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
 
 #include <user_interface/xlib_screen.hpp>
 
+static bool g_shm_attach_failed = false;
+
+static int shm_attach_error_handler(Display* display, XErrorEvent* event)
+{
+    g_shm_attach_failed = true;
+    return 0;
+}
+
 xlib_screen::xlib_screen(int width, int height, int xpos, int ypos, std::string title, bool fullscreen)
     : screen(width, height)
 {
@@ -82,13 +92,12 @@ xlib_screen::xlib_screen(int width, int height, int xpos, int ypos, std::string
         XRaiseWindow(display_, window_);
     }
 
-    // Connect cairo xlib surface to window
-    cairo_surface_t* xlib_surface = cairo_xlib_surface_create(display_, window_, DefaultVisual(display_, screen_), width, height);
-    cairo_xlib_surface_set_size(xlib_surface, width, height);
-    cairo_t* xlib_cr = cairo_create(xlib_surface);
-
-
-    root_surface_ = std::shared_ptr<surface>(new surface(xlib_surface, xlib_cr, static_cast<double>(width), static_cast<double>(height)));
+    // Render into an offscreen image. Damaged areas are copied to the window
+    // in present() so that partially drawn frames are never visible
+    if (!init_shm_back_buffer() && !init_back_buffer()) {
+        std::cerr << "Visual not compatible with back buffer, drawing directly on window" << std::endl;
+        init_window_surface();
+    }
 
     // Subscribe to input events
     long event_mask = ExposureMask;
@@ -126,6 +135,135 @@ xlib_screen::xlib_screen(int width, int height, int xpos, int ypos, std::string
 #endif
 }
 
+bool xlib_screen::back_buffer_compatible()
+{
+    // Cairo RGB24 is 0x00RRGGBB in native byte order
+    auto visual = DefaultVisual(display_, screen_);
+    return back_buffer_image_->bits_per_pixel == 32 &&
+           back_buffer_image_->bytes_per_line == cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, width_) &&
+           visual->red_mask == 0xff0000 &&
+           visual->green_mask == 0x00ff00 &&
+           visual->blue_mask == 0x0000ff;
+}
+
+void xlib_screen::set_back_buffer_byte_order()
+{
+    uint32_t byte_order_probe = 1;
+    bool lsb_first = *reinterpret_cast<uint8_t*>(&byte_order_probe) == 1;
+    back_buffer_image_->byte_order = lsb_first ? LSBFirst : MSBFirst;
+}
+
+bool xlib_screen::init_shm_back_buffer()
+{
+    if (!XShmQueryExtension(display_)) {
+        return false;
+    }
+
+    back_buffer_image_ = XShmCreateImage(display_, DefaultVisual(display_, screen_), DefaultDepth(display_, screen_),
+                                         ZPixmap, nullptr, &shm_info_, width_, height_);
+    if (back_buffer_image_ == nullptr) {
+        return false;
+    }
+
+    if (!back_buffer_compatible()) {
+        destroy_back_buffer_image();
+        return false;
+    }
+
+    shm_info_.shmid = shmget(IPC_PRIVATE, back_buffer_image_->bytes_per_line * back_buffer_image_->height, IPC_CREAT | 0600);
+    if (shm_info_.shmid < 0) {
+        destroy_back_buffer_image();
+        return false;
+    }
+
+    shm_info_.shmaddr = static_cast<char*>(shmat(shm_info_.shmid, nullptr, 0));
+    if (shm_info_.shmaddr == reinterpret_cast<char*>(-1)) {
+        shmctl(shm_info_.shmid, IPC_RMID, nullptr);
+        destroy_back_buffer_image();
+        return false;
+    }
+    shm_info_.readOnly = False;
+
+    // Attaching fails asynchronously, e.g. on a remote display
+    g_shm_attach_failed = false;
+    auto prev_handler = XSetErrorHandler(shm_attach_error_handler);
+    XShmAttach(display_, &shm_info_);
+    XSync(display_, False);
+    XSetErrorHandler(prev_handler);
+
+    // Segment is released when both client and server have detached
+    shmctl(shm_info_.shmid, IPC_RMID, nullptr);
+
+    if (g_shm_attach_failed) {
+        shmdt(shm_info_.shmaddr);
+        destroy_back_buffer_image();
+        return false;
+    }
+
+    shm_ = true;
+    back_buffer_image_->data = shm_info_.shmaddr;
+    set_back_buffer_byte_order();
+
+    cairo_surface_t* back_buffer = cairo_image_surface_create_for_data(reinterpret_cast<unsigned char*>(shm_info_.shmaddr),
+                                                                       CAIRO_FORMAT_RGB24, width_, height_,
+                                                                       back_buffer_image_->bytes_per_line);
+    gc_ = XCreateGC(display_, window_, 0, nullptr);
+
+    root_surface_ = std::shared_ptr<surface>(new surface(back_buffer, cairo_create(back_buffer), static_cast<double>(width_), static_cast<double>(height_)));
+
+    return true;
+}
+
+bool xlib_screen::init_back_buffer()
+{
+    cairo_surface_t* back_buffer = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width_, height_);
+    back_buffer_image_ = XCreateImage(display_, DefaultVisual(display_, screen_), DefaultDepth(display_, screen_), ZPixmap, 0,
+                                      reinterpret_cast<char*>(cairo_image_surface_get_data(back_buffer)),
+                                      width_, height_, 32, cairo_image_surface_get_stride(back_buffer));
+
+    if (back_buffer_image_ == nullptr || !back_buffer_compatible()) {
+        destroy_back_buffer_image();
+        cairo_surface_destroy(back_buffer);
+        return false;
+    }
+
+    set_back_buffer_byte_order();
+    gc_ = XCreateGC(display_, window_, 0, nullptr);
+
+    root_surface_ = std::shared_ptr<surface>(new surface(back_buffer, cairo_create(back_buffer), static_cast<double>(width_), static_cast<double>(height_)));
+
+    return true;
+}
+
+void xlib_screen::init_window_surface()
+{
+    // Connect cairo xlib surface to window
+    cairo_surface_t* xlib_surface = cairo_xlib_surface_create(display_, window_, DefaultVisual(display_, screen_), width_, height_);
+    cairo_xlib_surface_set_size(xlib_surface, width_, height_);
+    cairo_t* xlib_cr = cairo_create(xlib_surface);
+
+    root_surface_ = std::shared_ptr<surface>(new surface(xlib_surface, xlib_cr, static_cast<double>(width_), static_cast<double>(height_)));
+}
+
+void xlib_screen::destroy_back_buffer_image()
+{
+    if (back_buffer_image_ == nullptr) {
+        return;
+    }
+
+    if (shm_) {
+        XShmDetach(display_, &shm_info_);
+        XSync(display_, False);
+        shmdt(shm_info_.shmaddr);
+        shm_ = false;
+    }
+
+    // Pixel data is owned by the cairo back buffer or the shared memory segment
+    back_buffer_image_->data = nullptr;
+    XDestroyImage(back_buffer_image_);
+    back_buffer_image_ = nullptr;
+}
+
 xlib_screen::~xlib_screen()
 {
     if (!closed_) {
@@ -145,11 +283,10 @@ std::vector<std::shared_ptr<ui_event>> xlib_screen::poll_events()
   char text[10];
   memset(text, 0, sizeof(text));
 
-    while(true) {
-      auto event_in_queue = XCheckMaskEvent(display_, -1, &event);
-      if (!event_in_queue) {
-          break;
-      }
+    // Drain the whole queue, including non-maskable events such as
+    // ClientMessage. Anything left behind would keep the connection readable
+    while(XPending(display_) > 0) {
+      XNextEvent(display_, &event);
 
       switch(event.type) {
         case Expose: {
@@ -246,7 +383,7 @@ std::vector<std::shared_ptr<ui_event>> xlib_screen::poll_events()
             events.emplace_back(e);
             break;
         }
-        case ClientMessage: // TODO: currently is acquired only with XNextEvent() but not XCheckWindowEvent()
+        case ClientMessage:
             if (event.xclient.data.l[0] == wm_delete_) {
                 auto e = std::shared_ptr<ui_event>(new ui_event(ui_event_type::close,
                                       text[0]));
@@ -260,6 +397,18 @@ std::vector<std::shared_ptr<ui_event>> xlib_screen::poll_events()
 
 }
 
+int xlib_screen::connection_fd()
+{
+    return ConnectionNumber(display_);
+}
+
+bool xlib_screen::events_pending()
+{
+    // Flushes requests and also reports events that Xlib has already read
+    // from the socket, which epoll cannot see
+    return XPending(display_) > 0;
+}
+
 void xlib_screen::button_event(button flag, bool pressed)
 {
     if (pressed) {
@@ -269,10 +418,61 @@ void xlib_screen::button_event(button flag, bool pressed)
     }
 }
 
+void xlib_screen::present(cairo_region_t* damage)
+{
+    if (back_buffer_image_ == nullptr) {
+        XFlush(display_);
+        return;
+    }
+
+    cairo_surface_flush(root_surface_->handle());
+
+    auto nr_rects = cairo_region_num_rectangles(damage);
+    std::vector<XRectangle> clip_rects(nr_rects);
+    for(int i=0; i<nr_rects; i++) {
+        cairo_rectangle_int_t rect;
+        cairo_region_get_rectangle(damage, i, &rect);
+        clip_rects[i].x = static_cast<short>(rect.x);
+        clip_rects[i].y = static_cast<short>(rect.y);
+        clip_rects[i].width = static_cast<unsigned short>(rect.width);
+        clip_rects[i].height = static_cast<unsigned short>(rect.height);
+    }
+
+    cairo_rectangle_int_t extents;
+    cairo_region_get_extents(damage, &extents);
+
+    // Single request per frame: the bounding box is transferred and the
+    // clip list restricts the update to the damaged rectangles
+    XSetClipRectangles(display_, gc_, 0, 0, clip_rects.data(), nr_rects, YXBanded);
+
+    if (shm_) {
+        XShmPutImage(display_, window_, gc_, back_buffer_image_,
+                     extents.x, extents.y,
+                     extents.x, extents.y,
+                     extents.width, extents.height,
+                     False);
+
+        // The server reads the shared pixels while processing the request.
+        // Wait for it before the next frame is drawn into them
+        XSync(display_, False);
+    } else {
+        XPutImage(display_, window_, gc_, back_buffer_image_,
+                  extents.x, extents.y,
+                  extents.x, extents.y,
+                  extents.width, extents.height);
+        XFlush(display_);
+    }
+}
+
 void xlib_screen::close()
 {
     if (!closed_) {
         root_surface_->destroy();
+        destroy_back_buffer_image();
+        if (gc_ != nullptr) {
+            XFreeGC(display_, gc_);
+            gc_ = nullptr;
+        }
         XDestroyWindow(display_, window_);
         XCloseDisplay(display_);
         closed_ = true;